@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <climits>
+#include <cstdlib>
+#include <optional>
+#include <type_traits>
+
+#include "Search.hpp"
+#include "NodeOrder.hpp"
+
+namespace dijkstra {
+
+	/*
+	* Manhattan distance between two cells of a grid, admissible and consistent
+	* for 4-connected grids where every step costs at least 1.
+	*/
+	struct ManhattanDistance {
+		int grid_width;
+
+		int operator()(int node, int target) const {
+			return std::abs(node % grid_width - target % grid_width) + std::abs(node / grid_width - target / grid_width);
+		}
+	};
+
+	/*
+	* Manhattan distance on a grid whose cells are numbered by a NodeOrder.
+	*/
+	template <class Order>
+	struct OrderedManhattanDistance {
+		Order order;
+
+		int operator()(int node, int target) const {
+			return std::abs(order.x(node) - order.x(target)) + std::abs(order.y(node) - order.y(target));
+		}
+	};
+
+	/*
+	* The Manhattan distance heuristic for a grid graph, decoding coordinates
+	* with the graph's order() when it has one that is not row major.
+	*/
+	template <class Graph>
+	auto manhattanDistance(const Graph& graph) {
+		if constexpr (requires { graph.order(); }) {
+			using Order = std::remove_cvref_t<decltype(graph.order())>;
+			if constexpr (!std::is_same_v<Order, RowMajorOrder>)
+				return OrderedManhattanDistance<Order>{ graph.order() };
+			else
+				return ManhattanDistance{ graph.width() };
+		}
+		else {
+			return ManhattanDistance{ graph.width() };
+		}
+	}
+
+	/*
+	* Turns A* into Dijkstra with early termination, for graphs without geometry.
+	*/
+	struct ZeroHeuristic {
+		int operator()(int, int) const {
+			return 0;
+		}
+	};
+
+	/*
+	* Goal directed search from start to end. The search stops as soon as end is
+	* popped from the queue, so only the region between both nodes is expanded.
+	* Passing a workspace reuses its node records and heap between queries.
+	*
+	* Returns std::nullopt when end is not reachable from start.
+	*/
+	template <class Graph, class Heuristic, class Queue = BinaryHeap>
+	std::optional<std::vector<int>> aStar(const Graph& graph, int start, int end, Heuristic heuristic, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+		BasicSearchWorkspace<Queue> local_workspace{};
+		BasicSearchWorkspace<Queue>& search = workspace != nullptr ? *workspace : local_workspace;
+		search.reset(graph.size());
+
+		// (estimated total, heuristic): on equal estimates prefer the node closest to the target
+		int start_estimate = heuristic(start, end);
+		search.push(search.key(start_estimate, start_estimate), start);
+		search.update(start, 0, -1);
+
+		while (!search.heapEmpty()) {
+			auto [key, node] = search.pop();
+
+			if (node == end)
+				return search.pathTo(end);
+
+			// stale entry, node was already expanded with a better distance
+			int current_distance = search.distance(node);
+			if (keyPrimary(key) > current_distance + heuristic(node, end))
+				continue;
+
+			graph.forEachNeighbour(node, [&](int next_node) {
+				int weight = stepCost(graph, next_node);
+
+				if (search.distance(next_node) > (current_distance + weight)) {
+					search.update(next_node, current_distance + weight, node);
+
+					int h = heuristic(next_node, end);
+					search.push(search.key(current_distance + weight + h, h), next_node);
+				}
+			});
+		}
+		return std::nullopt;
+	}
+};
@@ -3,8 +3,14 @@
 #include <memory>
 #include <iostream>
 #include <functional>
-
-#include "Graph.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "GridGraph.hpp"
+#include "TreeIndex.hpp"
+#include "CorridorGraph.hpp"
+#include "ContractionHierarchy.hpp"
 #include "MazeGenerator.hpp"
 #include "ObstacleGenerator.hpp"
 
@@ -52,7 +58,7 @@ namespace dijkstra {
 					"Create window and renderer: %s" , SDL_GetError());
 				return false;
 			}
-			SDL_SetWindowTitle(window , "SDL Grid");
+			updateWindowTitle();
 			return true;
 		}
 
@@ -73,6 +79,8 @@ namespace dijkstra {
 
 				drawGrid();
 
+				drawTerrain();
+
 				//drawCursors();
 
 				if (visualize_dijkstra) {
@@ -151,14 +159,15 @@ namespace dijkstra {
 			target_node_color = { 252, 20, 45, 255 };
 			dijkstra_solution_color = { 251, 255, 0, 255 };
 
-			// this line is fucking stupid
-			graph = std::make_unique<dijkstra::WeightedGraph>(dijkstra::WeightedGraph::createAdjacencyList(grid_width, grid_height));
+			graph = std::make_unique<dijkstra::ImplicitGridGraph>(grid_width, grid_height);
+			graph->trackComponents();
 
 			index_to_coords_map = std::make_unique<std::vector<std::tuple<int, int>>>();
 
-			for (int x = 0; x < grid_height; x++)
-				for (int y = 0; y < grid_width; y++)
-					index_to_coords_map->push_back(std::make_pair(y, x));
+			// node ids follow the graph's order, ask it for every cell
+			auto order = graph->order();
+			for (int node = 0; node < graph->size(); node++)
+				index_to_coords_map->push_back(std::make_pair(order.x(node), order.y(node)));
 		}
 		
 		void drawDijkstra() {
@@ -220,13 +229,35 @@ namespace dijkstra {
 				drawCell(tx, ty, target_node_color);
 		}
 
-		void drawDisabledCells() {
-			for (int cell : disabled_cells) {
+		/*
+		* Cells that cost more than 1 to enter, darker the more they cost. The
+		* most expensive cell of the map gets the darkest shade, terrain uses
+		* only a few of the levels the cost type allows.
+		*/
+		void drawTerrain() {
+			if (graph->uniformCost())
+				return;
+
+			int max_cost = 1;
+			for (int cell = 0; cell < graph->size(); cell++)
+				max_cost = std::max(max_cost, graph->cost(cell));
+
+			for (int cell = 0; cell < graph->size(); cell++) {
+				int cost = graph->cost(cell);
+				if (cost == 1 || !graph->isPassable(cell))
+					continue;
 				auto [x, y] = index_to_coords_map->at(cell);
-				drawCell(x, y, { 0, 0, 0, 255 });
+				Uint8 shade = static_cast<Uint8>(230 - (cost * 160) / max_cost);
+				drawCell(x, y, { shade, static_cast<Uint8>(shade * 0.9), static_cast<Uint8>(shade * 0.6), 255 });
 			}
 		}
 
+		void drawDisabledCells() {
+			graph->passability().forEachReset([&](int x, int y) {
+				drawCell(x, y, { 0, 0, 0, 255 });
+			});
+		}
+
 		void drawCell(int x, int y, SDL_Color color) {
 			SDL_Rect cell = {
 				.x = x * grid_cell_size + 1,
@@ -238,9 +269,11 @@ namespace dijkstra {
 			SDL_RenderFillRect(renderer, &cell);
 		}
 
+		/*
+		* The graph's passability bitmap is the only record of disabled cells.
+		*/
 		bool isDisabled(int x, int y) {
-			int index = dijkstra::WeightedGraph::nodeIndex(x, y, grid_width);
-			return (std::find(disabled_cells.begin(), disabled_cells.end(), index) != disabled_cells.end());
+			return !graph->passability().test(x, y);
 		}
 
 		void handleKeyboardEvents(SDL_Event event) {
@@ -273,6 +306,12 @@ namespace dijkstra {
 			case SDLK_o:
 				generateObstacleGrid();
 				break;
+			case SDLK_t:
+				generateTerrain();
+				break;
+			case SDLK_e:
+				nextSearchEngine();
+				break;
 			case SDLK_ESCAPE:
 				quit = SDL_TRUE;
 				break;
@@ -322,21 +361,86 @@ namespace dijkstra {
 			if (graph.get() == nullptr)
 				exit(-1);
 
-			int start = dijkstra::WeightedGraph::nodeIndex(std::get<0>(starting_node), std::get<1>(starting_node), grid_width);
-			int end = dijkstra::WeightedGraph::nodeIndex(std::get<0>(target_node), std::get<1>(target_node), grid_width);
+			int start = graph->order().index(std::get<0>(starting_node), std::get<1>(starting_node));
+			int end = graph->order().index(std::get<0>(target_node), std::get<1>(target_node));
 			
-			dijkstra_solution = std::make_unique<std::vector<int>>(std::move(graph->shortestPath(start, end)));
+			std::optional<std::vector<int>> path;
+			if (start != end && !graph->connected(start, end)) {
+				// different components, neither the planner nor a search needs to run
+				path = std::nullopt;
+			}
+			else if (search_engine == SearchEngine::Automatic && mazeTree().isTree()) {
+				// a perfect maze has one path between any two cells, no search needed
+				path = maze_tree.path(start, end);
+			}
+			else if (search_engine == SearchEngine::Automatic && corridors.get() != nullptr) {
+				// an edited maze: still mostly corridors, search the junctions only
+				path = corridors->findPath(start, end);
+			}
+			else if (search_engine == SearchEngine::Automatic && contraction.get() != nullptr) {
+				// a generated map nobody edited yet: climb the hierarchy from both ends
+				path = contraction->findPath(start, end);
+			}
+			else if (search_engine == SearchEngine::Incremental) {
+				// the planner keeps its state while the target stays, cell toggles only repair it
+				if (planner.get() == nullptr || planner->goalNode() != end)
+					planner = std::make_unique<dijkstra::DStarLite<dijkstra::ImplicitGridGraph>>(*graph, start, end);
+				else if (planner->startNode() != start)
+					planner->setStart(start);
+				path = planner->findPath();
+			}
+			else if (search_engine == SearchEngine::Dial || !graph->uniformCost()) {
+				// Dial, and the engines falling back to it on terrain, keep a bucket queue workspace
+				path = graph->shortestPath(start, end, search_engine, &bucket_workspace);
+			}
+			else {
+				path = graph->shortestPath(start, end, search_engine, &search_workspace);
+			}
+
+			// an unreachable target leaves nothing to draw
+			dijkstra_solution = std::make_unique<std::vector<int>>(path.value_or(std::vector<int>{}));
 			visualize_dijkstra = true;
 		}
 
+		/*
+		* Cycles through the engines used by runDijkstra.
+		*/
+		void nextSearchEngine() {
+			int next = static_cast<int>(search_engine) + 1;
+			if (next > static_cast<int>(SearchEngine::Incremental))
+				next = 0;
+			search_engine = static_cast<SearchEngine>(next);
+			updateWindowTitle();
+		}
+
+		void updateWindowTitle() {
+			std::string title = std::string("SDL Grid - ") + searchEngineName(search_engine);
+			SDL_SetWindowTitle(window, title.c_str());
+		}
+
 		void reEnableCells() {
-			for (int i : disabled_cells)
-				enableCell(i);
-			disabled_cells.clear();
+			graph->rebuildFromOccupancy({});
+		}
+
+		/*
+		* The tree index of the current grid, rebuilt after edits. Building
+		* stops at the first cycle, so grids that are not mazes cost little.
+		*/
+		const dijkstra::TreeIndex& mazeTree() {
+			if (maze_tree_stale) {
+				maze_tree.build(*graph);
+				maze_tree_stale = false;
+			}
+			return maze_tree;
 		}
 
 		void resetGrid() {
 			reEnableCells();
+			graph->clearCosts();
+			planner.reset();
+			corridors.reset();
+			contraction.reset();
+			maze_tree_stale = true;
 			if (dijkstra_solution.get())
 				dijkstra_solution->clear();
 		}
@@ -344,112 +448,57 @@ namespace dijkstra {
 		void generateMaze() {
 			resetGrid();
 
-			auto mazeGenerator = std::make_unique<MazeGenerator>(grid_width, grid_height);
-			mazeGenerator->generate();
-			mazeGenerator->printMaze();
-			const auto& mazeMatrix = mazeGenerator->mazeMatrix();
-			for (int x = 0; x < mazeMatrix.size(); x++) {
-				for (int y = 0; y < mazeMatrix[x].size(); y++) {
-					if (mazeMatrix[x][y] == 0)
-						disableCell(dijkstra::WeightedGraph::nodeIndex(y, x, grid_width));
-				}
-			}
+			// the generator writes the bitmap the graph then takes over
+			dijkstra::GridBitmap cells(grid_width, grid_height);
+			auto mazeGenerator = std::make_unique<MazeGenerator<>>(grid_width, grid_height);
+			mazeGenerator->generate(cells);
+			mazeGenerator->printMaze(cells);
+			graph->assignPassability(std::move(cells));
+			corridors = std::make_unique<dijkstra::CorridorGraph<dijkstra::ImplicitGridGraph>>(*graph);
 		}
 
 		void generateObstacleGrid() {
 			resetGrid();
 
-			auto obstacleGridGenerator = std::make_unique<ObstacleGenerator>(grid_width, grid_height, 90);
-			obstacleGridGenerator->generate();
-			obstacleGridGenerator->printMaze();
-			const auto& matrix = obstacleGridGenerator->matrix();
-			for (int x = 0; x < matrix.size(); x++) {
-				for (int y = 0; y < matrix[x].size(); y++) {
-					if (matrix[x][y] == 0)
-						disableCell(dijkstra::WeightedGraph::nodeIndex(y, x, grid_width));
-				}
-			}
+			dijkstra::GridBitmap cells(grid_width, grid_height);
+			auto obstacleGridGenerator = std::make_unique<ObstacleGenerator<>>(grid_width, grid_height, 10);
+			obstacleGridGenerator->generateRows(cells);
+			obstacleGridGenerator->printMaze(cells);
+			graph->assignPassability(std::move(cells));
+			contraction = std::make_unique<dijkstra::ContractionHierarchy>(*graph);
 		}
 
 		/*
-		* Disables the clicked cell in the graph
+		* Obstacle grid whose open cells have terrain costs from 1 to 9.
 		*/
-		void toggleSelectedCell() {
-
-			/*
-			* Any given node can only have 4 neighbours:
-			* * node - 1
-			* * node + 1
-			* * node + grid_width
-			* * node - grid_width
-			*/
-			int node = dijkstra::WeightedGraph::nodeIndex(grid_cursor.x / grid_cell_size, grid_cursor.y / grid_cell_size, grid_width);
-			int n1 = node - 1;
-			int n2 = node + 1;
-			int n3 = node + grid_width;
-			int n4 = node - grid_width;
-
-			auto _node = std::find(disabled_cells.begin(), disabled_cells.end(), node);
-
-// can't use a lambda for this.
-#define O(n, fn) \
-	if (n > 0 && n < index_to_coords_map->size()) \
-			fn(node, n)
-
-			// enable the cell
-			if (_node != disabled_cells.end()) {
-				O(n1, graph->connectNodes);
-				O(n2, graph->connectNodes);
-				O(n3, graph->connectNodes);
-				O(n4, graph->connectNodes);
-
-				*_node = disabled_cells.back();
-				disabled_cells.pop_back();
-			}
-			else {
-				O(n1, graph->disconnectNodes);
-				O(n2, graph->disconnectNodes);
-				O(n3, graph->disconnectNodes);
-				O(n4, graph->disconnectNodes);
-				disabled_cells.push_back(node);
-			}
-#undef O
-		}
-
-		void enableCell(int cell) {
-			int n1 = cell - 1;
-			int n2 = cell + 1;
-			int n3 = cell + grid_width;
-			int n4 = cell - grid_width;
-
-#define O(n) \
-	if (n > 0 && n < index_to_coords_map->size()) \
-			graph->connectNodes(cell, n)
+		void generateTerrain() {
+			resetGrid();
 
-			O(n1);
-			O(n2);
-			O(n3);
-			O(n4);
-			disabled_cells.push_back(cell);
-#undef O
+			dijkstra::GridBitmap cells(grid_width, grid_height);
+			auto obstacleGridGenerator = std::make_unique<ObstacleGenerator<>>(grid_width, grid_height, 10);
+			obstacleGridGenerator->generateRows(cells);
+			auto order = graph->order();
+			obstacleGridGenerator->generateCosts(cells, 9, [&](int x, int y, int cost) {
+				graph->setCost(order.index(x, y), cost);
+			});
+			graph->assignPassability(std::move(cells));
+			contraction = std::make_unique<dijkstra::ContractionHierarchy>(*graph);
 		}
 
-		void disableCell(int cell) {
-			int n1 = cell - 1;
-			int n2 = cell + 1;
-			int n3 = cell + grid_width;
-			int n4 = cell - grid_width;
-
-#define O(n) \
-	if (n > 0 && n < index_to_coords_map->size()) \
-			graph->disconnectNodes(cell, n)
-
-			O(n1);
-			O(n2);
-			O(n3);
-			O(n4);
-			disabled_cells.push_back(cell);
-#undef O
+		/*
+		* Disables the clicked cell in the graph
+		*/
+		void toggleSelectedCell() {
+			int node = graph->order().index(grid_cursor.x / grid_cell_size, grid_cursor.y / grid_cell_size);
+
+			graph->toggleCell(node);
+			if (planner.get() != nullptr)
+				planner->updateCell(node);
+			if (corridors.get() != nullptr)
+				corridors->updateCell(node);
+			// the hierarchy only serves the map as generated
+			contraction.reset();
+			maze_tree_stale = true;
 		}
 
 	private:
@@ -473,15 +522,22 @@ namespace dijkstra {
 		bool visualize_dijkstra = false;
 		bool toggle_cells_mode = false;
 
+		SearchEngine search_engine = SearchEngine::Automatic;
+
 		std::tuple<int, int> starting_node{};
 		std::tuple<int, int> target_node{};
 
-		std::unique_ptr<dijkstra::WeightedGraph> graph;
+		std::unique_ptr<dijkstra::ImplicitGridGraph> graph;
+		dijkstra::SearchWorkspace search_workspace;
+		dijkstra::BasicSearchWorkspace<dijkstra::BucketQueue> bucket_workspace;
+		std::unique_ptr<dijkstra::DStarLite<dijkstra::ImplicitGridGraph>> planner;
+		std::unique_ptr<dijkstra::CorridorGraph<dijkstra::ImplicitGridGraph>> corridors;
+		std::unique_ptr<dijkstra::ContractionHierarchy> contraction;
+		dijkstra::TreeIndex maze_tree;
+		bool maze_tree_stale = true;
 		std::unique_ptr<std::vector<int>> dijkstra_solution;
 		std::unique_ptr<std::vector<std::tuple<int, int>>> index_to_coords_map;
 
-		std::vector<int> disabled_cells;
-
 		int window_width;
 		int window_height;
 
@@ -0,0 +1,1028 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <random>
+#include <sstream>
+
+#include "Graph.hpp"
+#include "GridGraph.hpp"
+#include "MazeGenerator.hpp"
+#include "ObstacleGenerator.hpp"
+#include "Random.hpp"
+#include "DStarLite.hpp"
+#include "TreeIndex.hpp"
+#include "CorridorGraph.hpp"
+#include "HierarchicalGraph.hpp"
+#include "ContractionHierarchy.hpp"
+#include "CompressedPathDatabase.hpp"
+#include "Landmarks.hpp"
+#include "GoalBounding.hpp"
+
+/*
+* Headless benchmark of the graph layouts, no SDL involved.
+*
+* Usage: DijkstraBenchmark [grid_width] [grid_height] [repetitions]
+*/
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	double millisecondsSince(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	void report(const std::string& layout, const std::string& stage, double ms) {
+		std::cout << layout << "\t" << stage << "\t" << ms << " ms" << std::endl;
+	}
+
+	template <class Adjacency, class Cost, class Order>
+	dijkstra::BasicWeightedGraph<Adjacency, Cost, Order> makeGraph(dijkstra::BasicWeightedGraph<Adjacency, Cost, Order>*, int w, int h) {
+		return { dijkstra::BasicWeightedGraph<Adjacency, Cost, Order>::createAdjacencyList(w, h), w, h };
+	}
+
+	dijkstra::ImplicitGridGraph makeGraph(dijkstra::ImplicitGridGraph*, int w, int h) {
+		return dijkstra::ImplicitGridGraph(w, h);
+	}
+
+	template <class Adjacency, class Cost, class Order>
+	void disableCell(dijkstra::BasicWeightedGraph<Adjacency, Cost, Order>& graph, int x, int y, int w, int h) {
+		const Order& order = graph.order();
+		int node = order.index(x, y);
+		if (x > 0)
+			graph.disconnectNodes(node, order.index(x - 1, y));
+		if (x < w - 1)
+			graph.disconnectNodes(node, order.index(x + 1, y));
+		if (y > 0)
+			graph.disconnectNodes(node, order.index(x, y - 1));
+		if (y < h - 1)
+			graph.disconnectNodes(node, order.index(x, y + 1));
+	}
+
+	/*
+	* Same arguments as the adjacency version for the templated callers, the
+	* bitmap needs no height.
+	*/
+	void disableCell(dijkstra::ImplicitGridGraph& graph, int x, int y, int w, int) {
+		graph.disableCell(dijkstra::nodeIndex(x, y, w));
+	}
+
+	/*
+	* Point to point queries between random cells at most max_offset cells apart
+	* along each axis, answered from the full shortest path tree and with shortestPath.
+	*/
+	template <class Graph>
+	void benchmarkQueries(const std::string& layout, const std::string& kind, const Graph& graph, int w, int h, int max_offset, int count) {
+		std::mt19937 rng(42);
+		std::uniform_int_distribution<int> offset(-max_offset, max_offset);
+
+		std::vector<std::pair<int, int>> queries;
+		for (int i = 0; i < count; i++) {
+			int x = std::uniform_int_distribution<int>(0, w - 1)(rng);
+			int y = std::uniform_int_distribution<int>(0, h - 1)(rng);
+			int tx = std::clamp(x + offset(rng), 0, w - 1);
+			int ty = std::clamp(y + offset(rng), 0, h - 1);
+			queries.emplace_back(dijkstra::nodeIndex(x, y, w), dijkstra::nodeIndex(tx, ty, w));
+		}
+
+		long long length = 0;
+		auto start = Clock::now();
+		for (auto [from, to] : queries)
+			length += dijkstra::pathFromParents(graph.dijkstra(from), to).size();
+		report(layout, kind + " tree walk", millisecondsSince(start) / count);
+
+		long long found = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			found += graph.shortestPath(from, to).value_or(std::vector<int>{}).size();
+		report(layout, kind + " shortestPath", millisecondsSince(start) / count);
+
+		dijkstra::SearchWorkspace workspace{};
+		long long reused = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			reused += graph.shortestPath(from, to, dijkstra::SearchEngine::Automatic, &workspace).value_or(std::vector<int>{}).size();
+		report(layout, kind + " shortestPath workspace", millisecondsSince(start) / count);
+
+		long long breadth_first = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			breadth_first += graph.shortestPath(from, to, dijkstra::SearchEngine::BreadthFirst).value_or(std::vector<int>{}).size();
+		report(layout, kind + " breadth first", millisecondsSince(start) / count);
+
+		if (length < found || found != breadth_first || found != reused)
+			std::cout << "path length mismatch" << std::endl;
+	}
+
+	/*
+	* Builds a grid graph with the given layout, raises some walls with a gap
+	* in them and runs full single-source searches from the top-left corner.
+	*/
+	template <class Graph>
+	void benchmarkLayout(const std::string& layout, int w, int h, int repetitions) {
+		auto start = Clock::now();
+		Graph graph = makeGraph(static_cast<Graph*>(nullptr), w, h);
+		report(layout, "build", millisecondsSince(start));
+
+		start = Clock::now();
+		for (int y = 2; y < h - 1; y += 4)
+			for (int x = (y % 8 == 2) ? 1 : 0; x < w - 1; x++)
+				disableCell(graph, x, y, w, h);
+		report(layout, "edit", millisecondsSince(start));
+
+		long long checksum = 0;
+		start = Clock::now();
+		for (int i = 0; i < repetitions; i++) {
+			std::vector<int> parents = graph.dijkstra(0);
+			checksum += parents.back();
+		}
+		report(layout, "dijkstra", millisecondsSince(start) / repetitions);
+
+		start = Clock::now();
+		for (int i = 0; i < repetitions; i++) {
+			std::vector<int> parents = dijkstra::dijkstraParents(graph, 0);
+			checksum += parents.back();
+		}
+		report(layout, "heap dijkstra", millisecondsSince(start) / repetitions);
+
+		benchmarkQueries(layout, "local", graph, w, h, 3, repetitions * 100);
+		benchmarkQueries(layout, "long", graph, w, h, w + h, repetitions);
+
+		if (checksum == -1)
+			std::cout << "unreachable" << std::endl;
+	}
+}
+
+namespace {
+
+	/*
+	* Open grid with 10% random obstacles, like ObstacleGenerator's default.
+	*/
+	dijkstra::ImplicitGridGraph makeObstacleGrid(int w, int h) {
+		dijkstra::ImplicitGridGraph graph(w, h);
+		std::mt19937 rng(7);
+		for (int i = 0; i < w * h; i++)
+			if (rng() % 100 < 10)
+				graph.disableCell(i);
+		graph.enableCell(0);
+		return graph;
+	}
+
+	/*
+	* Two cells drawn uniformly from the whole grid.
+	*/
+	std::pair<int, int> anyCells(const dijkstra::ImplicitGridGraph& grid, std::mt19937& rng) {
+		int from = rng() % grid.size();
+		int to = rng() % grid.size();
+		return { from, to };
+	}
+
+	/*
+	* count queries between passable cells picked by draw(grid, rng), only
+	* between cells of one component when connected is set.
+	*/
+	template <class Draw = decltype(&anyCells)>
+	std::vector<std::pair<int, int>> passableQueries(const dijkstra::ImplicitGridGraph& grid, int count, std::mt19937& rng, bool connected = false, Draw draw = &anyCells) {
+		std::vector<std::pair<int, int>> queries;
+		while (static_cast<int>(queries.size()) < count) {
+			auto [from, to] = draw(grid, rng);
+			if (grid.isPassable(from) && grid.isPassable(to) && (!connected || grid.connected(from, to)))
+				queries.emplace_back(from, to);
+		}
+		return queries;
+	}
+
+	/*
+	* Queries between connected cells, drawn from a generator of its own.
+	*/
+	std::vector<std::pair<int, int>> connectedQueries(const dijkstra::ImplicitGridGraph& grid, int count, unsigned seed) {
+		std::mt19937 rng(seed);
+		return passableQueries(grid, count, rng, true);
+	}
+
+	/*
+	* Distance fields over the obstacle grid, node by node and with the bit
+	* parallel kernel.
+	*/
+	void benchmarkDistanceField(int w, int h, int repetitions) {
+		dijkstra::ImplicitGridGraph graph = makeObstacleGrid(w, h);
+
+		long long checksum = 0;
+		auto start = Clock::now();
+		for (int i = 0; i < repetitions; i++)
+			checksum += graph.dijkstra(0).back();
+		report("obstacles", "breadth first tree", millisecondsSince(start) / repetitions);
+
+		dijkstra::BitParallelBFS kernel(graph.passability());
+		std::vector<int> distances;
+		start = Clock::now();
+		for (int i = 0; i < repetitions; i++)
+			checksum += kernel.run(0, 0, &distances);
+		report("obstacles", "bit parallel distances", millisecondsSince(start) / repetitions);
+
+		start = Clock::now();
+		for (int i = 0; i < repetitions; i++)
+			checksum += kernel.reach(0, 0);
+		report("obstacles", "bit parallel reachability", millisecondsSince(start) / repetitions);
+
+		if (checksum == -1)
+			std::cout << "unreachable" << std::endl;
+	}
+}
+
+namespace {
+
+	/*
+	* Random long queries over the obstacle grid with A*, JPS and JPS+.
+	*/
+	void benchmarkJumpPoints(int w, int h, int count) {
+		dijkstra::ImplicitGridGraph graph = makeObstacleGrid(w, h);
+		std::mt19937 rng(11);
+
+		std::vector<std::pair<int, int>> queries = passableQueries(graph, count, rng);
+
+		long long astar_length = 0;
+		auto start = Clock::now();
+		for (auto [from, to] : queries)
+			astar_length += graph.shortestPath(from, to, dijkstra::SearchEngine::AStar).value_or(std::vector<int>{}).size();
+		report("obstacles", "astar query", millisecondsSince(start) / count);
+
+		for (bool plus : { false, true }) {
+			start = Clock::now();
+			dijkstra::JumpPointSearch search(graph.passability(), plus);
+			if (plus)
+				report("obstacles", "jps+ tables", millisecondsSince(start));
+
+			long long length = 0;
+			long long expanded = 0;
+			start = Clock::now();
+			for (auto [from, to] : queries) {
+				length += search.findPath(from, to).value_or(std::vector<int>{}).size();
+				expanded += search.expandedNodes();
+			}
+			report("obstacles", plus ? "jps+ query" : "jps query", millisecondsSince(start) / count);
+			std::cout << "obstacles\t" << (plus ? "jps+" : "jps") << " expanded jump points\t" << expanded / count << std::endl;
+
+			if (length != astar_length)
+				std::cout << "path length mismatch" << std::endl;
+		}
+	}
+}
+
+namespace {
+
+	/*
+	* Perfect maze from MazeGenerator, walls are disabled cells.
+	*/
+	dijkstra::ImplicitGridGraph makeMaze(int w, int h) {
+		dijkstra::ImplicitGridGraph graph(w, h);
+		dijkstra::GridBitmap cells(w, h);
+		MazeGenerator generator(w, h, 5);
+		generator.generate(cells);
+		graph.assignPassability(std::move(cells));
+		return graph;
+	}
+
+	/*
+	* Random queries between open maze cells: forward only, bidirectional,
+	* through the tree index of the maze and on its contracted corridors.
+	*/
+	void benchmarkBidirectional(int w, int h, int count) {
+		dijkstra::ImplicitGridGraph graph = makeMaze(w, h);
+		std::mt19937 rng(13);
+
+		std::vector<std::pair<int, int>> queries = passableQueries(graph, count, rng);
+
+		long long forward_length = 0;
+		auto start = Clock::now();
+		for (auto [from, to] : queries)
+			forward_length += graph.shortestPath(from, to, dijkstra::SearchEngine::BreadthFirst).value_or(std::vector<int>{}).size();
+		report("maze", "breadth first query", millisecondsSince(start) / count);
+
+		dijkstra::BidirectionalSearch search(graph.size());
+		long long length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			length += search.findPath(graph, from, to).value_or(std::vector<int>{}).size();
+		report("maze", "bidirectional query", millisecondsSince(start) / count);
+
+		start = Clock::now();
+		dijkstra::TreeIndex tree(graph);
+		report("maze", "tree index build", millisecondsSince(start));
+
+		long long tree_length = 0;
+		long long tree_distance = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			tree_length += tree.path(from, to).value_or(std::vector<int>{}).size();
+		report("maze", "tree index path", millisecondsSince(start) / count);
+
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			tree_distance += tree.distance(from, to).value_or(-1) + 1;
+		report("maze", "tree index distance", millisecondsSince(start) / count);
+
+		start = Clock::now();
+		dijkstra::CorridorGraph<dijkstra::ImplicitGridGraph> corridors(graph);
+		report("maze", "corridor contraction", millisecondsSince(start));
+		std::cout << "maze\tcorridor junctions\t" << corridors.junctionCount() << " of " << graph.size() << " cells" << std::endl;
+
+		long long corridor_length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			corridor_length += corridors.findPath(from, to).value_or(std::vector<int>{}).size();
+		report("maze", "corridor query", millisecondsSince(start) / count);
+
+		if (length != forward_length || tree_length != forward_length || tree_distance != forward_length || corridor_length != forward_length)
+			std::cout << "path length mismatch" << std::endl;
+	}
+}
+
+namespace {
+
+	/*
+	* Long A* queries and a full heap Dijkstra with one priority queue policy.
+	*/
+	template <class Queue>
+	void benchmarkQueue(const std::string& map, const std::string& queue, const dijkstra::ImplicitGridGraph& graph, const std::vector<std::pair<int, int>>& queries) {
+		dijkstra::BasicSearchWorkspace<Queue> workspace(graph.size());
+
+		long long length = 0;
+		auto start = Clock::now();
+		for (auto [from, to] : queries)
+			length += graph.shortestPath(from, to, dijkstra::SearchEngine::AStar, &workspace).value_or(std::vector<int>{}).size();
+		report(map, queue + " astar query", millisecondsSince(start) / queries.size());
+
+		start = Clock::now();
+		length += dijkstra::dijkstraParents(graph, queries.front().first, &workspace).back();
+		report(map, queue + " heap dijkstra", millisecondsSince(start));
+
+		if (length == -1)
+			std::cout << "unreachable" << std::endl;
+	}
+
+	/*
+	* Every priority queue policy on the open grid, the obstacle grid and a maze.
+	*/
+	void benchmarkQueues(int w, int h, int count) {
+		std::pair<std::string, dijkstra::ImplicitGridGraph> maps[] = {
+			{ "open", dijkstra::ImplicitGridGraph(w, h) },
+			{ "obstacles", makeObstacleGrid(w, h) },
+			{ "maze", makeMaze(w, h) },
+		};
+
+		for (const auto& [map, graph] : maps) {
+			std::mt19937 rng(17);
+			std::vector<std::pair<int, int>> queries = passableQueries(graph, count, rng);
+
+			benchmarkQueue<dijkstra::BinaryHeap>(map, "binary", graph, queries);
+			benchmarkQueue<dijkstra::QuaternaryHeap>(map, "4-ary", graph, queries);
+			benchmarkQueue<dijkstra::PairingHeap>(map, "pairing", graph, queries);
+			benchmarkQueue<dijkstra::RadixHeap>(map, "radix", graph, queries);
+		}
+	}
+}
+
+namespace {
+
+	/*
+	* Obstacle grid with terrain costs from 1 to max_cost in 8x8 patches.
+	*/
+	dijkstra::ImplicitGridGraph makeTerrainGrid(int w, int h, int max_cost) {
+		dijkstra::ImplicitGridGraph graph = makeObstacleGrid(w, h);
+		dijkstra::Xoshiro256 rng(19);
+		dijkstra::generatePatchCosts(rng, graph.passability(), max_cost, [&](int x, int y, int cost) {
+			graph.setCost(x + y * w, cost);
+		});
+		return graph;
+	}
+
+	/*
+	* Point to point queries over terrain: comparison heaps against Dial's buckets.
+	*/
+	void benchmarkTerrain(int w, int h, int count) {
+		for (int max_cost : { 9, 255 }) {
+			dijkstra::ImplicitGridGraph graph = makeTerrainGrid(w, h, max_cost);
+			std::string map = "terrain " + std::to_string(max_cost);
+			std::mt19937 rng(23);
+
+			std::vector<std::pair<int, int>> queries = passableQueries(graph, count, rng);
+
+			dijkstra::SearchWorkspace heap_workspace(graph.size());
+			dijkstra::BasicSearchWorkspace<dijkstra::BucketQueue> bucket_workspace(graph.size());
+			std::pair<std::string, dijkstra::SearchEngine> runs[] = {
+				{ "dijkstra", dijkstra::SearchEngine::Dijkstra },
+				{ "astar", dijkstra::SearchEngine::AStar },
+			};
+
+			long long checksum = 0;
+			for (const auto& [name, engine] : runs) {
+				auto start = Clock::now();
+				for (auto [from, to] : queries)
+					checksum += graph.shortestPath(from, to, engine, &heap_workspace).value_or(std::vector<int>{}).size();
+				report(map, "binary heap " + name + " query", millisecondsSince(start) / count);
+
+				start = Clock::now();
+				for (auto [from, to] : queries)
+					checksum += graph.shortestPath(from, to, engine, &bucket_workspace).value_or(std::vector<int>{}).size();
+				report(map, "bucket queue " + name + " query", millisecondsSince(start) / count);
+			}
+
+			if (checksum == -1)
+				std::cout << "unreachable" << std::endl;
+		}
+	}
+}
+
+namespace {
+
+	/*
+	* Replanning on the obstacle grid while a few cells toggle per tick, one of
+	* them always on the current path: D* Lite repairs, A* starts over.
+	*/
+	void benchmarkIncremental(int w, int h, int ticks) {
+		dijkstra::ImplicitGridGraph graph = makeObstacleGrid(w, h);
+		int start = 0;
+		int goal = w * h - 1;
+		graph.enableCell(goal);
+
+		auto begin = Clock::now();
+		dijkstra::DStarLite<dijkstra::ImplicitGridGraph> planner(graph, start, goal);
+		std::vector<int> path = planner.findPath().value_or(std::vector<int>{});
+		report("obstacles", "d* lite first plan", millisecondsSince(begin));
+		std::cout << "obstacles\td* lite first plan expanded\t" << planner.expandedNodes() << std::endl;
+
+		std::mt19937 rng(29);
+		double replan_ms = 0;
+		double astar_ms = 0;
+		long long expanded = 0;
+		int mismatches = 0;
+		dijkstra::SearchWorkspace workspace(graph.size());
+
+		for (int tick = 0; tick < ticks && path.size() > 2; tick++) {
+			std::vector<int> changed{ path[1 + rng() % (path.size() - 2)] };
+			for (int i = 0; i < 3; i++)
+				changed.push_back(1 + rng() % (w * h - 2));
+			for (int cell : changed)
+				graph.toggleCell(cell);
+
+			begin = Clock::now();
+			for (int cell : changed)
+				planner.updateCell(cell);
+			std::optional<std::vector<int>> repaired = planner.findPath();
+			replan_ms += millisecondsSince(begin);
+			expanded += planner.expandedNodes();
+
+			begin = Clock::now();
+			std::optional<std::vector<int>> scratch = graph.shortestPath(start, goal, dijkstra::SearchEngine::AStar, &workspace);
+			astar_ms += millisecondsSince(begin);
+
+			if (repaired.has_value() != scratch.has_value() || (repaired && repaired->size() != scratch->size()))
+				mismatches++;
+			path = repaired.value_or(std::vector<int>{});
+		}
+
+		report("obstacles", "d* lite replan", replan_ms / ticks);
+		std::cout << "obstacles\td* lite replan expanded\t" << expanded / ticks << std::endl;
+		report("obstacles", "astar from scratch", astar_ms / ticks);
+		if (mismatches > 0)
+			std::cout << "path length mismatch" << std::endl;
+	}
+}
+
+namespace {
+
+	/*
+	* Component index upkeep while cells toggle, and what it saves on queries
+	* whose target is walled off: every engine would flood the start's
+	* component, the index answers from two labels.
+	*/
+	void benchmarkComponents(const std::string& map, dijkstra::ImplicitGridGraph graph, int toggles) {
+		int w = graph.width();
+		int h = graph.height();
+
+		auto begin = Clock::now();
+		graph.trackComponents();
+		report(map, "component index build", millisecondsSince(begin));
+
+		std::mt19937 rng(31);
+		begin = Clock::now();
+		for (int i = 0; i < toggles; i++)
+			graph.toggleCell(rng() % (w * h));
+		report(map, "component index toggle", millisecondsSince(begin) / toggles);
+
+		// wall in the last cell, then ask for it from the first
+		int start = 0;
+		int goal = w * h - 1;
+		graph.enableCell(start);
+		graph.enableCell(goal);
+		graph.disableCell(goal - 1);
+		graph.disableCell(goal - w);
+
+		int queries = 10;
+		dijkstra::SearchWorkspace workspace(graph.size());
+		long long checksum = 0;
+		begin = Clock::now();
+		for (int i = 0; i < queries; i++)
+			checksum += graph.shortestPath(start, goal, dijkstra::SearchEngine::AStar, &workspace).has_value();
+		report(map, "unreachable query indexed", millisecondsSince(begin) / queries);
+
+		graph.trackComponents(false);
+		begin = Clock::now();
+		for (int i = 0; i < queries; i++)
+			checksum += graph.shortestPath(start, goal, dijkstra::SearchEngine::AStar, &workspace).has_value();
+		report(map, "unreachable query searched", millisecondsSince(begin) / queries);
+
+		if (checksum != 0)
+			std::cout << "walled off target reached" << std::endl;
+	}
+}
+
+namespace {
+
+	/*
+	* HPA* against flat A* on long queries across the obstacle grid, per
+	* hierarchy depth, plus the cost of patching it after a cell toggle.
+	*/
+	void benchmarkHierarchy(int w, int h, int count) {
+		dijkstra::ImplicitGridGraph graph = makeObstacleGrid(w, h);
+		std::mt19937 rng(37);
+		// opposite corners, long enough to climb the hierarchy
+		std::vector<std::pair<int, int>> queries = passableQueries(graph, count, rng, false, [&](const dijkstra::ImplicitGridGraph&, std::mt19937& random) {
+			int from = random() % (w / 8) + random() % (h / 8) * w;
+			int to = w - 1 - random() % (w / 8) + (h - 1 - random() % (h / 8)) * w;
+			return std::pair{ from, to };
+		});
+
+		dijkstra::SearchWorkspace workspace(graph.size());
+		long long optimal = 0;
+		auto start = Clock::now();
+		for (auto [from, to] : queries)
+			optimal += graph.shortestPath(from, to, dijkstra::SearchEngine::AStar, &workspace).value_or(std::vector<int>{}).size();
+		report("obstacles", "flat astar query", millisecondsSince(start) / count);
+
+		for (int levels = 1; levels <= 3; levels++) {
+			std::string name = "hpa* " + std::to_string(levels) + " level";
+			start = Clock::now();
+			dijkstra::HierarchicalGraph<dijkstra::ImplicitGridGraph> hierarchy(graph, 16, levels);
+			report("obstacles", name + " build", millisecondsSince(start));
+
+			long long length = 0;
+			start = Clock::now();
+			for (auto [from, to] : queries)
+				length += hierarchy.findPath(from, to).value_or(std::vector<int>{}).size();
+			report("obstacles", name + " query", millisecondsSince(start) / count);
+			std::cout << "obstacles\t" << name << " path length\t" << static_cast<double>(length) / optimal << "x optimal" << std::endl;
+
+			int toggles = 100;
+			start = Clock::now();
+			for (int i = 0; i < toggles; i++) {
+				int cell = rng() % (w * h);
+				graph.toggleCell(cell);
+				hierarchy.updateCell(cell);
+				graph.toggleCell(cell);
+				hierarchy.updateCell(cell);
+			}
+			report("obstacles", name + " cell update", millisecondsSince(start) / (2 * toggles));
+		}
+
+		// a single column or row, where node - 1 may be the cell above
+		int mismatches = 0;
+		for (auto [narrow_w, narrow_h] : { std::pair{ 1, 10 }, std::pair{ 10, 1 } }) {
+			dijkstra::ImplicitGridGraph narrow(narrow_w, narrow_h);
+			for (int levels = 1; levels <= 2; levels++) {
+				dijkstra::HierarchicalGraph<dijkstra::ImplicitGridGraph> hierarchy(narrow, 4, levels);
+				for (int from = 0; from < narrow.size(); from++) {
+					for (int to = 0; to < narrow.size(); to++) {
+						auto path = hierarchy.findPath(from, to);
+						if (!path || static_cast<int>(path->size()) != std::abs(from - to) + 1)
+							mismatches++;
+					}
+				}
+			}
+		}
+		if (mismatches > 0)
+			std::cout << "path length mismatch" << std::endl;
+	}
+
+	/*
+	* The csr layout of a grid, with the same cells disabled.
+	*/
+	dijkstra::WeightedGraph makeCsrGraph(const dijkstra::ImplicitGridGraph& grid) {
+		int w = grid.width();
+		int h = grid.height();
+		dijkstra::WeightedGraph graph = makeGraph(static_cast<dijkstra::WeightedGraph*>(nullptr), w, h);
+		for (int node = 0; node < grid.size(); node++)
+			if (!grid.isPassable(node))
+				disableCell(graph, node % w, node / w, w, h);
+		return graph;
+	}
+
+	/*
+	* Contraction Hierarchies on the csr layout of an obstacle grid, queried
+	* between random connected cells.
+	*/
+	void benchmarkContraction(int w, int h, int count) {
+		dijkstra::ImplicitGridGraph grid = makeObstacleGrid(w, h);
+		dijkstra::WeightedGraph graph = makeCsrGraph(grid);
+		std::vector<std::pair<int, int>> queries = connectedQueries(grid, count, 41);
+
+		dijkstra::SearchWorkspace workspace(graph.size());
+		long long astar_length = 0;
+		auto start = Clock::now();
+		for (auto [from, to] : queries)
+			astar_length += graph.shortestPath(from, to, dijkstra::SearchEngine::AStar, &workspace).value_or(std::vector<int>{}).size();
+		report("obstacles", "flat astar query", millisecondsSince(start) / count);
+
+		long long dijkstra_length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			dijkstra_length += graph.shortestPath(from, to, dijkstra::SearchEngine::Dijkstra, &workspace).value_or(std::vector<int>{}).size();
+		report("obstacles", "flat dijkstra query", millisecondsSince(start) / count);
+
+		start = Clock::now();
+		dijkstra::ContractionHierarchy hierarchy(graph);
+		report("obstacles", "contraction build", millisecondsSince(start));
+		std::cout << "obstacles\tcontraction arcs\t" << hierarchy.arcCount() << std::endl;
+
+		std::stringstream stream;
+		start = Clock::now();
+		hierarchy.save(stream);
+		dijkstra::ContractionHierarchy loaded;
+		loaded.load(stream);
+		report("obstacles", "contraction save and load", millisecondsSince(start));
+
+		// distances count steps, paths count cells
+		long long distance_length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			distance_length += loaded.distance(from, to).value_or(-1) + 1;
+		report("obstacles", "contraction distance query", millisecondsSince(start) / count);
+
+		long long contraction_length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			contraction_length += loaded.findPath(from, to).value_or(std::vector<int>{}).size();
+		report("obstacles", "contraction path query", millisecondsSince(start) / count);
+
+		if (dijkstra_length != astar_length || distance_length != astar_length || contraction_length != astar_length)
+			std::cout << "path length mismatch" << std::endl;
+	}
+
+	/*
+	* Compressed path database on the csr layout of an obstacle grid, built,
+	* saved, mapped back and walked between random connected cells.
+	*/
+	void benchmarkPathDatabase(int w, int h, int count) {
+		dijkstra::ImplicitGridGraph grid = makeObstacleGrid(w, h);
+		dijkstra::WeightedGraph graph = makeCsrGraph(grid);
+		std::vector<std::pair<int, int>> queries = connectedQueries(grid, count, 43);
+
+		dijkstra::SearchWorkspace workspace(graph.size());
+		auto start = Clock::now();
+		long long cells = 0;
+		for (auto [from, to] : queries)
+			cells += graph.shortestPath(from, to, dijkstra::SearchEngine::AStar, &workspace).value_or(std::vector<int>{}).size();
+		report("obstacles", "flat astar query", millisecondsSince(start) / count);
+
+		dijkstra::CompressedPathDatabase database(graph);
+		dijkstra::CompressedPathDatabase::Statistics statistics = database.statistics();
+		report("obstacles", "path database build", statistics.build_milliseconds);
+		std::cout << "obstacles\tpath database runs\t" << statistics.runs << " (" << static_cast<double>(statistics.runs) / statistics.nodes << " per row)" << std::endl;
+		std::cout << "obstacles\tpath database size\t" << statistics.bytes / 1024 << " KiB, "
+			<< static_cast<double>(statistics.bytes) / (static_cast<double>(statistics.nodes) * statistics.nodes) << " of a byte per pair" << std::endl;
+
+		std::string file = "DijkstraBenchmark.cpd";
+		start = Clock::now();
+		database.save(file);
+		std::optional<dijkstra::CompressedPathDatabase> mapped = dijkstra::CompressedPathDatabase::open(file);
+		report("obstacles", "path database save and map", millisecondsSince(start));
+		if (!mapped)
+			return;
+
+		long long length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			length += mapped->path(graph, from, to).value_or(std::vector<int>{}).size();
+		report("obstacles", "path database path query", millisecondsSince(start) / count);
+		std::cout << "obstacles\tpath database path length\t" << static_cast<double>(length) / cells << "x optimal" << std::endl;
+
+		int found = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			found += mapped->firstMove(from, to) != -1;
+		report("obstacles", "path database first move", millisecondsSince(start) / count);
+		std::cout << "obstacles\tpath database first moves\t" << found << " of " << count << std::endl;
+		mapped.reset();
+		std::remove(file.c_str());
+	}
+
+	/*
+	* A* on a maze with some walls knocked out, with Manhattan distance and
+	* with landmark heuristics from both selection strategies.
+	*/
+	void benchmarkLandmarks(int w, int h, int count) {
+		dijkstra::ImplicitGridGraph graph = makeMaze(w, h);
+		std::mt19937 rng(47);
+		for (int i = 0; i < w * h / 50; i++)
+			graph.enableCell(rng() % graph.size());
+		std::vector<std::pair<int, int>> queries = connectedQueries(graph, count, 53);
+
+		dijkstra::SearchWorkspace workspace(graph.size());
+		long long optimal = 0;
+		auto start = Clock::now();
+		for (auto [from, to] : queries)
+			optimal += graph.shortestPath(from, to, dijkstra::SearchEngine::AStar, &workspace).value_or(std::vector<int>{}).size();
+		report("maze", "manhattan astar query", millisecondsSince(start) / count);
+
+		std::pair<std::string, dijkstra::LandmarkSelection> selections[] = {
+			{ "farthest", dijkstra::LandmarkSelection::FarthestPoint },
+			{ "avoid", dijkstra::LandmarkSelection::Avoid },
+		};
+		for (auto [name, selection] : selections) {
+			start = Clock::now();
+			dijkstra::Landmarks landmarks(graph, 8, selection);
+			report("maze", "alt " + name + " select", millisecondsSince(start));
+
+			start = Clock::now();
+			landmarks.refresh(graph);
+			report("maze", "alt " + name + " refresh", millisecondsSince(start));
+			std::cout << "maze\talt " << name << " tables\t" << landmarks.tableBytes() / 1024 << " KiB" << std::endl;
+
+			long long length = 0;
+			start = Clock::now();
+			for (auto [from, to] : queries)
+				length += dijkstra::aStar(graph, from, to, landmarks.heuristic(), &workspace).value_or(std::vector<int>{}).size();
+			report("maze", "alt " + name + " query", millisecondsSince(start) / count);
+			if (length != optimal)
+				std::cout << "maze\talt " << name << " paths differ from A*" << std::endl;
+		}
+	}
+
+	/*
+	* A* and JPS plain and pruned by goal bounding, on a maze with some walls
+	* knocked out.
+	*/
+	void benchmarkGoalBounding(int w, int h, int count) {
+		dijkstra::ImplicitGridGraph graph = makeMaze(w, h);
+		std::mt19937 rng(61);
+		for (int i = 0; i < w * h / 50; i++)
+			graph.enableCell(rng() % graph.size());
+		std::vector<std::pair<int, int>> queries = connectedQueries(graph, count, 59);
+
+		auto start = Clock::now();
+		dijkstra::GoalBounding bounds(graph);
+		report("maze", "goal bounding build", millisecondsSince(start));
+		std::cout << "maze\tgoal bounding tables\t" << bounds.tableBytes() / 1024 << " KiB" << std::endl;
+
+		dijkstra::SearchWorkspace workspace(graph.size());
+		dijkstra::ManhattanDistance heuristic{ w };
+		long long astar_length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			astar_length += dijkstra::aStar(graph, from, to, heuristic, &workspace).value_or(std::vector<int>{}).size();
+		report("maze", "astar query", millisecondsSince(start) / count);
+
+		long long bounded_length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			bounded_length += dijkstra::aStar(dijkstra::GoalBoundedGraph<dijkstra::ImplicitGridGraph>(graph, bounds, to), from, to, heuristic, &workspace).value_or(std::vector<int>{}).size();
+		report("maze", "goal bounded astar query", millisecondsSince(start) / count);
+		if (bounded_length != astar_length)
+			std::cout << "path length mismatch" << std::endl;
+
+		dijkstra::JumpPointSearch search(graph.passability());
+		for (bool bounded : { false, true }) {
+			search.setGoalBounding(bounded ? &bounds : nullptr);
+			long long expanded = 0;
+			long long length = 0;
+			start = Clock::now();
+			for (auto [from, to] : queries) {
+				length += search.findPath(from, to, &workspace).value_or(std::vector<int>{}).size();
+				expanded += search.expandedNodes();
+			}
+			std::string name = bounded ? "goal bounded jps" : "jps";
+			report("maze", name + " query", millisecondsSince(start) / count);
+			std::cout << "maze\t" << name << " expanded\t" << expanded / count << " jump points" << std::endl;
+			if (length != astar_length)
+				std::cout << "path length mismatch" << std::endl;
+		}
+	}
+
+	/*
+	* Share of edges whose ends fall in the same 64 byte line of a per node
+	* int array, like the workspace distances.
+	*/
+	template <class Graph>
+	void reportLocality(const std::string& order, const Graph& graph) {
+		long long edges = 0;
+		long long same_line = 0;
+		for (int node = 0; node < graph.size(); node++) {
+			graph.forEachNeighbour(node, [&](int next_node) {
+				edges++;
+				same_line += node / 16 == next_node / 16;
+			});
+		}
+		std::cout << order << "\tneighbours in one cache line\t" << 100.0 * same_line / edges << " %" << std::endl;
+	}
+
+	/*
+	* The obstacle grid as a csr graph numbered in the given node order,
+	* searched from and between the same cells whatever the order. Returns
+	* the total path length, equal for every order.
+	*/
+	template <class Graph>
+	long long benchmarkNodeOrder(const std::string& order_name, const dijkstra::ImplicitGridGraph& grid, const std::vector<std::pair<int, int>>& queries, int repetitions) {
+		int w = grid.width();
+		int h = grid.height();
+		auto start = Clock::now();
+		Graph graph = makeGraph(static_cast<Graph*>(nullptr), w, h);
+		for (int node = 0; node < grid.size(); node++)
+			if (!grid.isPassable(node))
+				disableCell(graph, node % w, node / w, w, h);
+		report(order_name, "build", millisecondsSince(start));
+		reportLocality(order_name, graph);
+
+		auto cell = [&](int row_major) {
+			return graph.order().index(row_major % w, row_major / w);
+		};
+
+		dijkstra::SearchWorkspace workspace(graph.size());
+		long long checksum = 0;
+		start = Clock::now();
+		for (int i = 0; i < repetitions; i++)
+			checksum += dijkstra::dijkstraParents(graph, cell(queries[i % queries.size()].first), &workspace).size();
+		report(order_name, "dijkstra tree", millisecondsSince(start) / repetitions);
+
+		long long length = 0;
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			length += graph.shortestPath(cell(from), cell(to), dijkstra::SearchEngine::AStar, &workspace).value_or(std::vector<int>{}).size();
+		report(order_name, "astar query", millisecondsSince(start) / queries.size());
+
+		start = Clock::now();
+		for (auto [from, to] : queries)
+			checksum += graph.shortestPath(cell(from), cell(to), dijkstra::SearchEngine::BreadthFirst, &workspace).value_or(std::vector<int>{}).size();
+		report(order_name, "breadth first query", millisecondsSince(start) / queries.size());
+
+		if (checksum == -1)
+			std::cout << "unreachable" << std::endl;
+		return length;
+	}
+
+	/*
+	* Regenerating the map of a graph: a fresh grid with a disableCell per
+	* blocked cell against one rebuildFromOccupancy pass over the old graph.
+	*/
+	template <class Graph>
+	void benchmarkRebuild(const std::string& layout, const std::vector<std::uint8_t>& occupancy, int w, int h) {
+		auto start = Clock::now();
+		Graph graph = makeGraph(static_cast<Graph*>(nullptr), w, h);
+		for (int y = 0; y < h; y++)
+			for (int x = 0; x < w; x++)
+				if (occupancy[x + static_cast<size_t>(y) * w] == 0)
+					disableCell(graph, x, y, w, h);
+		report(layout, "build and apply per cell", millisecondsSince(start));
+
+		Graph rebuilt = makeGraph(static_cast<Graph*>(nullptr), w, h);
+		rebuilt.rebuildFromOccupancy(occupancy);
+		start = Clock::now();
+		rebuilt.rebuildFromOccupancy(occupancy);
+		report(layout, "rebuild from occupancy", millisecondsSince(start));
+
+		long long mismatches = 0;
+		for (int node = 0; node < graph.size(); node++) {
+			int degree = 0;
+			graph.forEachNeighbour(node, [&](int) { degree++; });
+			rebuilt.forEachNeighbour(node, [&](int) { degree--; });
+			mismatches += degree != 0;
+		}
+		if (mismatches != 0)
+			std::cout << "rebuild mismatch" << std::endl;
+	}
+
+	void benchmarkRebuilds(int w, int h) {
+		std::vector<std::uint8_t> occupancy(static_cast<size_t>(w) * h);
+		std::mt19937 rng(11);
+		// about as many walls as a maze
+		for (std::uint8_t& cell : occupancy)
+			cell = rng() % 2;
+
+		benchmarkRebuild<dijkstra::WeightedGraph>("csr", occupancy, w, h);
+		benchmarkRebuild<dijkstra::ImplicitGridGraph>("implicit", occupancy, w, h);
+	}
+
+	/*
+	* One bounded draw per cell, as the obstacle generator makes, from libc
+	* and from each engine of Random.hpp.
+	*/
+	template <class Draw>
+	void benchmarkDraws(const std::string& name, int cells, Draw&& draw) {
+		long long blocked = 0;
+		auto start = Clock::now();
+		for (int i = 0; i < cells; i++)
+			blocked += draw() < 10;
+		double ms = millisecondsSince(start);
+		std::cout << name << "\tdraws per microsecond\t" << cells / ms / 1000 << ", " << 100.0 * blocked / cells << " % below 10" << std::endl;
+	}
+
+	void benchmarkRandom(int w, int h) {
+		int cells = w * h;
+		std::srand(1);
+		benchmarkDraws("rand", cells, [] { return std::rand() % 100; });
+		dijkstra::Xoshiro256 xoshiro(1);
+		benchmarkDraws("xoshiro256**", cells, [&] { return static_cast<int>(dijkstra::uniformBelow(xoshiro, 100)); });
+		dijkstra::Pcg32 pcg(1);
+		benchmarkDraws("pcg32", cells, [&] { return static_cast<int>(dijkstra::uniformBelow(pcg, 100)); });
+		dijkstra::Philox4x32 philox(1);
+		benchmarkDraws("philox4x32", cells, [&] { return static_cast<int>(dijkstra::uniformBelow(philox, 100)); });
+
+		// the same seed must give the same map
+		dijkstra::GridBitmap first(w, h);
+		dijkstra::GridBitmap second(w, h);
+		auto start = Clock::now();
+		ObstacleGenerator(w, h, 10, 3).generate(first);
+		report("obstacles", "generate", millisecondsSince(start));
+		ObstacleGenerator(w, h, 10, 3).generate(second);
+		for (int y = 0; y < h; y++)
+			if (!std::equal(first.row(y), first.row(y) + first.rowWords(), second.row(y)))
+				std::cout << "generation not reproducible" << std::endl;
+	}
+
+	/*
+	* Obstacle fields cell by cell and a packed word at a time over threads,
+	* the bulk fill also on a stress map of about 100M cells. Bulk fills must
+	* not depend on the thread count.
+	*/
+	void benchmarkObstacleFill(int w, int h) {
+		dijkstra::GridBitmap cells(w, h);
+		auto start = Clock::now();
+		ObstacleGenerator(w, h, 10, 3).generate(cells);
+		report("obstacles", "generate per cell", millisecondsSince(start));
+
+		dijkstra::GridBitmap single(w, h);
+		start = Clock::now();
+		ObstacleGenerator(w, h, 10, 3).generateRows(single, 1);
+		report("obstacles", "generate rows, 1 thread", millisecondsSince(start));
+		start = Clock::now();
+		ObstacleGenerator(w, h, 10, 3).generateRows(cells);
+		report("obstacles", "generate rows", millisecondsSince(start));
+		for (int y = 0; y < h; y++)
+			if (!std::equal(cells.row(y), cells.row(y) + cells.rowWords(), single.row(y)))
+				std::cout << "generation depends on threads" << std::endl;
+
+		int side = 10000;
+		dijkstra::GridBitmap stress(side, side);
+		start = Clock::now();
+		ObstacleGenerator(side, side, 10, 3).generateRows(stress);
+		report("obstacles", "generate rows 10000x10000", millisecondsSince(start));
+		std::cout << "obstacles\tstress map open cells\t" << stress.count() << std::endl;
+	}
+
+	/*
+	* Row major, Morton and tiled numbering of the same large obstacle grid.
+	*/
+	void benchmarkNodeOrders(int w, int h, int repetitions) {
+		dijkstra::ImplicitGridGraph grid = makeObstacleGrid(w, h);
+		std::vector<std::pair<int, int>> queries = connectedQueries(grid, repetitions * 10, 43);
+
+		long long row_major = benchmarkNodeOrder<dijkstra::WeightedGraph>("row major", grid, queries, repetitions);
+		long long morton = benchmarkNodeOrder<dijkstra::MortonWeightedGraph>("morton", grid, queries, repetitions);
+		long long tiled = benchmarkNodeOrder<dijkstra::TiledWeightedGraph>("tiled 8x8", grid, queries, repetitions);
+		if (morton != row_major || tiled != row_major)
+			std::cout << "path length mismatch" << std::endl;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	int w = argc > 1 ? std::atoi(argv[1]) : 2048;
+	int h = argc > 2 ? std::atoi(argv[2]) : 2048;
+	int repetitions = argc > 3 ? std::atoi(argv[3]) : 3;
+
+	std::cout << "grid " << w << "x" << h << ", " << repetitions << " repetitions" << std::endl;
+
+	benchmarkLayout<dijkstra::NestedWeightedGraph>("nested", w, h, repetitions);
+	benchmarkLayout<dijkstra::WeightedGraph>("csr", w, h, repetitions);
+	benchmarkLayout<dijkstra::ImplicitGridGraph>("implicit", w, h, repetitions);
+	benchmarkDistanceField(w, h, repetitions);
+	benchmarkJumpPoints(w, h, repetitions * 10);
+	benchmarkBidirectional(w, h, repetitions * 10);
+	benchmarkQueues(w, h, repetitions * 10);
+	benchmarkTerrain(w, h, repetitions * 10);
+	benchmarkIncremental(w, h, repetitions * 10);
+	benchmarkHierarchy(w, h, repetitions * 10);
+	benchmarkContraction(w / 8, h / 8, repetitions * 100);
+	benchmarkPathDatabase(w / 16, h / 16, repetitions * 100);
+	benchmarkLandmarks(w, h, repetitions * 10);
+	benchmarkGoalBounding(w / 16, h / 16, repetitions * 100);
+	benchmarkNodeOrders(w, h, repetitions);
+	benchmarkRebuilds(w, h);
+	benchmarkRandom(w, h);
+	benchmarkObstacleFill(w, h);
+	benchmarkComponents("obstacles", makeObstacleGrid(w, h), repetitions * 1000);
+	benchmarkComponents("maze", makeMaze(w, h), repetitions * 1000);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+
+#include "SearchWorkspace.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Bidirectional breadth first search for undirected uniform cost graphs.
+	 *
+	 * One search grows from start and one from end, always expanding a whole
+	 * level of the side with the smaller frontier. The first edge found
+	 * between both searches closes a shortest path: every node of the other
+	 * side adjacent to the level being expanded lies on that side's newest
+	 * level (an older node would have been expanded already and the meeting
+	 * found then), so all connections found in this level have the same length.
+	 *
+	 * Both directions share one SearchWorkspace, kept between queries unless
+	 * the caller passes its own.
+	 */
+	class BidirectionalSearch {
+	public:
+		BidirectionalSearch(int size = 0)
+			:own_workspace(size) {
+		}
+
+	public:
+		template <class Graph, class Queue = BinaryHeap>
+		std::optional<std::vector<int>> findPath(const Graph& graph, int start, int end, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+			if (workspace == nullptr)
+				return findPath(graph, start, end, &own_workspace);
+
+			BasicSearchWorkspace<Queue>& search = *workspace;
+			search.reset(graph.size());
+
+			if (start == end)
+				return std::vector<int>{ start };
+
+			search.visit(start, -1, k_forward);
+			search.queue(k_forward).push(start);
+			search.visit(end, -1, k_backward);
+			search.queue(k_backward).push(end);
+
+			int meet_from = -1;
+			int meet_to = -1;
+			int meet_side = k_forward;
+
+			while (meet_from == -1 && !search.queue(k_forward).empty() && !search.queue(k_backward).empty()) {
+				int side = search.queue(k_forward).size() <= search.queue(k_backward).size() ? k_forward : k_backward;
+				int other = 1 - side;
+				RingQueue& queue = search.queue(side);
+
+				for (int level_size = queue.size(); level_size > 0 && meet_from == -1; level_size--) {
+					int node = queue.pop();
+
+					graph.forEachNeighbour(node, [&](int next_node) {
+						if (meet_from != -1)
+							return;
+
+						if (search.reached(next_node, other)) {
+							meet_from = node;
+							meet_to = next_node;
+							meet_side = side;
+							return;
+						}
+
+						if (!search.reached(next_node, side)) {
+							search.visit(next_node, node, side);
+							queue.push(next_node);
+						}
+					});
+				}
+			}
+
+			if (meet_from == -1)
+				return std::nullopt;
+
+			// meet_from belongs to meet_side, meet_to to the other side
+			int forward_end = meet_side == k_forward ? meet_from : meet_to;
+			int backward_start = meet_side == k_forward ? meet_to : meet_from;
+
+			std::vector<int> path = search.pathTo(forward_end);
+			search.walkParents(backward_start, [&](int node) { path.push_back(node); }, k_backward);
+			return path;
+		}
+
+	private:
+		enum { k_forward = SearchWorkspace::k_forward, k_backward = SearchWorkspace::k_backward };
+
+	private:
+		SearchWorkspace own_workspace;
+	};
+};
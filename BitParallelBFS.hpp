@@ -0,0 +1,427 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DIJKSTRA_BFS_SSE2
+#endif
+
+#include "GridBitmap.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Breadth first search over a passability bitmap that expands whole words
+	 * of cells at once.
+	 *
+	 * Frontier, visited and passable cells are packed bit rows. The next level
+	 * of a row is
+	 *
+	 *     (frontier << 1 | frontier >> 1 | frontier above | frontier below) & passable & ~visited
+	 *
+	 * computed 64 cells per word, or 128/256 cells per instruction when SSE2/AVX2
+	 * are enabled at compile time.
+	 *
+	 * To avoid touching the whole grid on every level, each frontier row keeps
+	 * a summary with one bit per non empty word; only words next to a non empty
+	 * frontier word are expanded. Every level still visits every row the
+	 * frontier crosses, so distance fields only pay off when frontiers are wide
+	 * along rows; a diagonal front holding one cell per row is slower than a
+	 * plain breadth first search.
+	 *
+	 * Pure reachability queries skip the levels and flood whole passable runs
+	 * of a row at once instead, see reach().
+	 *
+	 * Buffers are kept between runs, one instance can answer many queries over
+	 * the same bitmap.
+	 */
+	class BitParallelBFS {
+	public:
+		using Word = GridBitmap::Word;
+
+		BitParallelBFS(const GridBitmap& passable)
+			:grid_width(passable.width()), grid_height(passable.height()),
+			row_words(passable.rowWords()), stride(passable.rowWords() + 2),
+			summary_words((passable.rowWords() + 63) / 64) {
+
+			// one guard word on each side of a row and one guard row above and below,
+			// so the kernel never needs bounds checks
+			size_t total = static_cast<size_t>(stride) * (grid_height + 2);
+			passable_words.assign(total, 0);
+			visited.assign(total, 0);
+			frontier.assign(total, 0);
+			next.assign(total, 0);
+
+			frontier_summary.assign(static_cast<size_t>(summary_words) * grid_height, 0);
+			next_summary.assign(static_cast<size_t>(summary_words) * grid_height, 0);
+			candidate_summary.assign(summary_words, 0);
+			fill_buffer.assign(row_words, 0);
+
+			for (int y = 0; y < grid_height; y++) {
+				const Word* source = passable.row(y);
+				std::copy(source, source + row_words, row(passable_words, y));
+			}
+		}
+
+	public:
+		/*
+		* Runs a full search from (start_x, start_y). When distances is not null it
+		* is resized to the grid and filled with the level of every cell, -1 for
+		* unreachable cells.
+		*
+		* Returns the number of reachable cells, start included.
+		*/
+		long long run(int start_x, int start_y, std::vector<int>* distances = nullptr) {
+			std::fill(visited.begin(), visited.end(), 0);
+			if (distances)
+				distances->assign(static_cast<size_t>(grid_width) * grid_height, -1);
+
+			Word start_bit = Word{ 1 } << (start_x % 64);
+			int start_word = start_x / 64;
+
+			row(visited, start_y)[start_word] |= start_bit;
+			if (distances)
+				(*distances)[static_cast<size_t>(start_y) * grid_width + start_x] = 0;
+
+			level_count = 0;
+
+			// a blocked start cell has no neighbours
+			if (!(row(passable_words, start_y)[start_word] & start_bit))
+				return 1;
+
+			row(frontier, start_y)[start_word] = start_bit;
+			summary(frontier_summary, start_y)[start_word / 64] |= Word{ 1 } << (start_word % 64);
+			active_rows.assign(1, start_y);
+
+			long long reached = 1;
+
+			for (int level = 1; !active_rows.empty(); level++) {
+				candidateRows();
+				next_rows.clear();
+
+				for (int y : candidate_rows) {
+					long long found = expandRow(y, level, distances);
+					if (found) {
+						reached += found;
+						next_rows.push_back(y);
+					}
+				}
+
+				// the old frontier becomes the (cleared) next buffer
+				for (int y : active_rows)
+					clearRow(frontier, frontier_summary, y);
+
+				frontier.swap(next);
+				frontier_summary.swap(next_summary);
+				active_rows.swap(next_rows);
+				level_count = level;
+			}
+			return reached;
+		}
+
+		/*
+		* Reachability only: floods the component of (start_x, start_y) without
+		* keeping levels, so whole passable runs of a row are filled at once
+		* (carry propagation upwards, shift fill downwards). Rows are revisited
+		* until no row above or below adds new cells.
+		*
+		* Returns the number of reachable cells, start included.
+		*/
+		long long reach(int start_x, int start_y) {
+			std::fill(visited.begin(), visited.end(), 0);
+			level_count = 0;
+
+			Word start_bit = Word{ 1 } << (start_x % 64);
+			int start_word = start_x / 64;
+			row(visited, start_y)[start_word] |= start_bit;
+
+			if (!(row(passable_words, start_y)[start_word] & start_bit))
+				return 1;
+
+			// the start cell is already visited, so its row and both neighbour rows
+			// have to be filled once even if the start row itself gains nothing
+			queued_rows.assign(grid_height, 0);
+			row_queue.clear();
+			for (int r = std::max(start_y - 1, 0); r <= std::min(start_y + 1, grid_height - 1); r++) {
+				queued_rows[r] = 1;
+				row_queue.push_back(r);
+			}
+
+			while (!row_queue.empty()) {
+				int y = row_queue.front();
+				row_queue.pop_front();
+				queued_rows[y] = 0;
+
+				if (!fillRow(y))
+					continue;
+
+				for (int r : { y - 1, y + 1 }) {
+					if (r < 0 || r >= grid_height || queued_rows[r])
+						continue;
+					queued_rows[r] = 1;
+					row_queue.push_back(r);
+				}
+			}
+
+			long long reached = 0;
+			for (int y = 0; y < grid_height; y++) {
+				const Word* v = row(visited, y);
+				for (int i = 0; i < row_words; i++)
+					reached += std::popcount(v[i]);
+			}
+			return reached;
+		}
+
+		/*
+		* Cells reached by the last run.
+		*/
+		GridBitmap reachable() const {
+			GridBitmap result(grid_width, grid_height);
+			for (int y = 0; y < grid_height; y++) {
+				const Word* source = row(visited, y);
+				std::copy(source, source + row_words, result.row(y));
+			}
+			return result;
+		}
+
+		/*
+		* Eccentricity of the start cell in the last run.
+		*/
+		int levels() const {
+			return level_count;
+		}
+
+	private:
+		Word* row(std::vector<Word>& words, int y) {
+			return words.data() + static_cast<size_t>(y + 1) * stride + 1;
+		}
+
+		const Word* row(const std::vector<Word>& words, int y) const {
+			return words.data() + static_cast<size_t>(y + 1) * stride + 1;
+		}
+
+		Word* summary(std::vector<Word>& words, int y) {
+			return words.data() + static_cast<size_t>(y) * summary_words;
+		}
+
+		/*
+		* Imports the visited cells of the rows above and below into row y and
+		* fills every passable run holding one of them. Returns true when the
+		* row gained cells.
+		*/
+		bool fillRow(int y) {
+			const Word* up = row(visited, y - 1);
+			const Word* down = row(visited, y + 1);
+			const Word* p = row(passable_words, y);
+			Word* v = row(visited, y);
+
+			// fill towards higher x: adding the seeds to the passable bits carries
+			// through the rest of each run, the changed bits are the filled ones
+			Word carry = 0;
+			for (int i = 0; i < row_words; i++) {
+				Word seeds = (v[i] | up[i] | down[i] | carry) & p[i];
+				Word sum = p[i] + seeds;
+				Word filled = ((sum ^ p[i]) & p[i]) | seeds;
+				carry = filled >> 63;
+				fill_buffer[i] = filled;
+			}
+
+			// fill towards lower x with an occluded shift fill
+			bool changed = false;
+			carry = 0;
+			for (int i = row_words - 1; i >= 0; i--) {
+				Word gen = fill_buffer[i] | ((carry << 63) & p[i]);
+				Word pro = p[i];
+				gen |= pro & (gen >> 1);
+				pro &= pro >> 1;
+				gen |= pro & (gen >> 2);
+				pro &= pro >> 2;
+				gen |= pro & (gen >> 4);
+				pro &= pro >> 4;
+				gen |= pro & (gen >> 8);
+				pro &= pro >> 8;
+				gen |= pro & (gen >> 16);
+				pro &= pro >> 16;
+				gen |= pro & (gen >> 32);
+				carry = gen & 1;
+
+				changed |= (gen != v[i]);
+				v[i] = gen;
+			}
+			return changed;
+		}
+
+		/*
+		* Rows next to an active frontier row, sorted and without duplicates.
+		*/
+		void candidateRows() {
+			candidate_rows.clear();
+			for (int y : active_rows) {
+				for (int r = std::max(y - 1, 0); r <= std::min(y + 1, grid_height - 1); r++) {
+					if (candidate_rows.empty() || candidate_rows.back() < r)
+						candidate_rows.push_back(r);
+				}
+			}
+		}
+
+		void clearRow(std::vector<Word>& words, std::vector<Word>& summaries, int y) {
+			Word* r = row(words, y);
+			Word* s = summary(summaries, y);
+			for (int k = 0; k < summary_words; k++) {
+				for (Word bits = s[k]; bits; bits &= bits - 1)
+					r[k * 64 + std::countr_zero(bits)] = 0;
+				s[k] = 0;
+			}
+		}
+
+		/*
+		* Computes the next frontier of row y, only around non empty frontier
+		* words of rows y - 1, y and y + 1. Returns the number of new cells.
+		*/
+		long long expandRow(int y, int level, std::vector<int>* distances) {
+			// words to expand: frontier words of the three rows, dilated by one word
+			Word carry_left = 0;
+			for (int k = 0; k < summary_words; k++) {
+				Word s = summary(frontier_summary, y)[k];
+				if (y > 0)
+					s |= summary(frontier_summary, y - 1)[k];
+				if (y < grid_height - 1)
+					s |= summary(frontier_summary, y + 1)[k];
+				candidate_summary[k] = s;
+			}
+			for (int k = 0; k < summary_words; k++) {
+				Word s = candidate_summary[k];
+				Word carry_right = (k + 1 < summary_words) ? (candidate_summary[k + 1] << 63) : 0;
+				Word dilated = s | (s << 1) | (s >> 1) | carry_left | carry_right;
+				carry_left = s >> 63;
+				candidate_summary[k] = dilated;
+			}
+
+			long long found = 0;
+			for (int k = 0; k < summary_words; k++) {
+				Word bits = candidate_summary[k];
+				while (bits) {
+					// contiguous run of candidate words [begin, end)
+					int first = std::countr_zero(bits);
+					int length = std::countr_one(bits >> first);
+					int begin = k * 64 + first;
+					int end = std::min(begin + length, row_words);
+
+					if (begin >= row_words)
+						break;
+
+					found += expandWords(y, begin, end, level, distances);
+
+					bits = (first + length >= 64) ? 0 : (bits & ~(((Word{ 1 } << length) - 1) << first));
+				}
+			}
+			return found;
+		}
+
+		long long expandWords(int y, int begin, int end, int level, std::vector<int>* distances) {
+			const Word* f = row(frontier, y);
+			const Word* up = row(frontier, y - 1);
+			const Word* down = row(frontier, y + 1);
+			const Word* p = row(passable_words, y);
+			Word* v = row(visited, y);
+			Word* n = row(next, y);
+
+			int i = begin;
+
+#if defined(__AVX2__)
+			for (; i + 4 <= end; i += 4) {
+				__m256i fc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + i));
+				__m256i fl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + i - 1));
+				__m256i fr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + i + 1));
+				__m256i fu = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + i));
+				__m256i fd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + i));
+				__m256i pv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+				__m256i vv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+
+				__m256i spread = _mm256_or_si256(
+					_mm256_or_si256(_mm256_slli_epi64(fc, 1), _mm256_srli_epi64(fl, 63)),
+					_mm256_or_si256(_mm256_srli_epi64(fc, 1), _mm256_slli_epi64(fr, 63)));
+				spread = _mm256_or_si256(spread, _mm256_or_si256(fu, fd));
+				__m256i nv = _mm256_andnot_si256(vv, _mm256_and_si256(spread, pv));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(n + i), nv);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(v + i), _mm256_or_si256(vv, nv));
+			}
+#elif defined(DIJKSTRA_BFS_SSE2)
+			for (; i + 2 <= end; i += 2) {
+				__m128i fc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f + i));
+				__m128i fl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f + i - 1));
+				__m128i fr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f + i + 1));
+				__m128i fu = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + i));
+				__m128i fd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + i));
+				__m128i pv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+				__m128i vv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+
+				__m128i spread = _mm_or_si128(
+					_mm_or_si128(_mm_slli_epi64(fc, 1), _mm_srli_epi64(fl, 63)),
+					_mm_or_si128(_mm_srli_epi64(fc, 1), _mm_slli_epi64(fr, 63)));
+				spread = _mm_or_si128(spread, _mm_or_si128(fu, fd));
+				__m128i nv = _mm_andnot_si128(vv, _mm_and_si128(spread, pv));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(n + i), nv);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), _mm_or_si128(vv, nv));
+			}
+#endif
+			for (; i < end; i++) {
+				Word spread = (f[i] << 1) | (f[i - 1] >> 63) | (f[i] >> 1) | (f[i + 1] << 63) | up[i] | down[i];
+				Word nv = spread & p[i] & ~v[i];
+				n[i] = nv;
+				v[i] |= nv;
+			}
+
+			// record the non empty words and the level of every new cell
+			long long found = 0;
+			Word* s = summary(next_summary, y);
+			for (i = begin; i < end; i++) {
+				if (!n[i])
+					continue;
+				s[i / 64] |= Word{ 1 } << (i % 64);
+				found += std::popcount(n[i]);
+
+				if (distances) {
+					int* d = distances->data() + static_cast<size_t>(y) * grid_width + i * 64;
+					for (Word bits = n[i]; bits; bits &= bits - 1)
+						d[std::countr_zero(bits)] = level;
+				}
+			}
+			return found;
+		}
+
+	private:
+		int grid_width;
+		int grid_height;
+		int row_words;
+		int stride;
+		int summary_words;
+		int level_count = 0;
+
+		std::vector<Word> passable_words;
+		std::vector<Word> visited;
+		std::vector<Word> frontier;
+		std::vector<Word> next;
+
+		std::vector<Word> frontier_summary;
+		std::vector<Word> next_summary;
+		std::vector<Word> candidate_summary;
+
+		std::vector<int> active_rows;
+		std::vector<int> next_rows;
+		std::vector<int> candidate_rows;
+
+		std::vector<Word> fill_buffer;
+		std::deque<int> row_queue;
+		std::vector<char> queued_rows;
+	};
+};
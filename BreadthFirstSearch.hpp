@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+#include "Search.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * One bit per node.
+	 */
+	class NodeBitset {
+	public:
+		NodeBitset(int size = 0)
+			:words((size + 63) / 64, 0) {
+		}
+
+	public:
+		bool test(int node) const {
+			return (words[node >> 6] >> (node & 63)) & 1;
+		}
+
+		void set(int node) {
+			words[node >> 6] |= std::uint64_t{ 1 } << (node & 63);
+		}
+
+		/*
+		* Sets the bit and returns its previous value.
+		*/
+		bool testAndSet(int node) {
+			std::uint64_t mask = std::uint64_t{ 1 } << (node & 63);
+			bool was_set = words[node >> 6] & mask;
+			words[node >> 6] |= mask;
+			return was_set;
+		}
+
+		void resize(int size) {
+			words.assign((size + 63) / 64, 0);
+		}
+
+	private:
+		std::vector<std::uint64_t> words;
+	};
+
+	/*
+	* Breadth first search for graphs where every edge costs the same. Each
+	* node is queued at most once, so this is O(V + E) with no heap at all.
+	*
+	* Returns the parents array of the search tree rooted at start. When end is
+	* given the search stops as soon as end is discovered. The queue is taken
+	* from workspace when one is given, otherwise a ring queue of its own
+	* grows with the frontier, no per node arrays are set up for it.
+	*/
+	template <class Graph, class Queue = BinaryHeap>
+	std::vector<int> breadthFirstParents(const Graph& graph, int start, int end = -1, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+		RingQueue local_queue{};
+		if (workspace != nullptr)
+			workspace->reset(graph.size());
+		RingQueue& queued_nodes = workspace != nullptr ? workspace->queue() : local_queue;
+
+		std::vector<int> parents(graph.size(), -1);
+		NodeBitset visited(graph.size());
+
+		visited.set(start);
+		queued_nodes.push(start);
+
+		while (!queued_nodes.empty()) {
+			int node = queued_nodes.pop();
+			bool found = false;
+
+			graph.forEachNeighbour(node, [&](int next_node) {
+				if (visited.testAndSet(next_node))
+					return;
+				parents[next_node] = node;
+				queued_nodes.push(next_node);
+				found |= (next_node == end);
+			});
+
+			if (found)
+				break;
+		}
+		return parents;
+	}
+
+	/*
+	* Point to point breadth first search, std::nullopt if end is unreachable.
+	*
+	* With a workspace nodes are stamped in it, so a warm workspace answers
+	* short queries without touching the rest of the graph. Without one a
+	* one-off visited bitset is cheaper than allocating a whole workspace.
+	*/
+	template <class Graph, class Queue = BinaryHeap>
+	std::optional<std::vector<int>> breadthFirstSearch(const Graph& graph, int start, int end, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+		if (start == end)
+			return std::vector<int>{ start };
+
+		if (workspace == nullptr) {
+			std::vector<int> parents = breadthFirstParents(graph, start, end);
+			if (parents[end] == -1)
+				return std::nullopt;
+			return pathFromParents(parents, end);
+		}
+
+		BasicSearchWorkspace<Queue>& search = *workspace;
+		search.reset(graph.size());
+
+		RingQueue& queued_nodes = search.queue();
+		search.visit(start, -1);
+		queued_nodes.push(start);
+
+		while (!queued_nodes.empty()) {
+			int node = queued_nodes.pop();
+			bool found = false;
+
+			graph.forEachNeighbour(node, [&](int next_node) {
+				if (search.reached(next_node))
+					return;
+				search.visit(next_node, node);
+				queued_nodes.push(next_node);
+				found |= (next_node == end);
+			});
+
+			if (found)
+				return search.pathTo(end);
+		}
+		return std::nullopt;
+	}
+};
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+
+#include "GridBitmap.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Connected components of the passable cells of a 4-connected grid, so
+	 * that two cells can be checked for a path between them in O(1).
+	 *
+	 * Every passable cell holds a component label and labels are merged with
+	 * union-find. Enabling a cell only merges the labels around it. Disabling
+	 * a cell can split its component: when its passable neighbours are still
+	 * linked through the ring of eight cells around it nothing changes,
+	 * otherwise one breadth first search per side runs in lockstep until the
+	 * sides meet again or all but one are exhausted. Exhausted sides get new
+	 * labels, so the work is bounded by the smaller sides of the split.
+	 *
+	 * The index keeps no reference to the bitmap, so it copies and moves with
+	 * the graph that owns it. Every cell change has to be passed in along
+	 * with the bitmap, after the bitmap was updated.
+	 */
+	class ComponentIndex {
+	public:
+		ComponentIndex(const GridBitmap& passable) {
+			rebuild(passable);
+		}
+
+	public:
+		/*
+		* Labels every cell from scratch with a union-find pass over the grid.
+		*/
+		void rebuild(const GridBitmap& bitmap) {
+			int w = bitmap.width();
+			int size = w * bitmap.height();
+
+			label_parents.resize(size);
+			std::iota(label_parents.begin(), label_parents.end(), 0);
+			for (int y = 0; y < bitmap.height(); y++) {
+				for (int x = 0; x < w; x++) {
+					if (!bitmap.test(x, y))
+						continue;
+					int node = x + y * w;
+					if (x > 0 && bitmap.test(x - 1, y))
+						unite(node, node - 1);
+					if (y > 0 && bitmap.test(x, y - 1))
+						unite(node, node - w);
+				}
+			}
+
+			// compact the roots into dense labels
+			labels.assign(size, -1);
+			std::vector<int> root_labels(size, -1);
+			int count = 0;
+			for (int node = 0; node < size; node++) {
+				if (!bitmap.test(node % w, node / w))
+					continue;
+				int root = find(node);
+				if (root_labels[root] == -1)
+					root_labels[root] = count++;
+				labels[node] = root_labels[root];
+			}
+			label_parents.resize(count);
+			std::iota(label_parents.begin(), label_parents.end(), 0);
+
+			stamps.assign(size, 0);
+			stamp_groups.assign(size, 0);
+			generation = 0;
+		}
+
+		/*
+		* True when a path exists between a and b, false if either is blocked.
+		*/
+		bool connected(int a, int b) const {
+			return labels[a] != -1 && labels[b] != -1 && root(labels[a]) == root(labels[b]);
+		}
+
+		/*
+		* Same label for every cell in one component, -1 for blocked cells.
+		*/
+		int component(int node) const {
+			return labels[node] == -1 ? -1 : root(labels[node]);
+		}
+
+		void cellEnabled(const GridBitmap& bitmap, int node) {
+			int label = -1;
+			forEachPassableNeighbour(bitmap, node, [&](int next_node) {
+				if (label == -1)
+					label = find(labels[next_node]);
+				else
+					unite(label, labels[next_node]);
+			});
+			labels[node] = label != -1 ? label : freshLabel();
+		}
+
+		void cellDisabled(const GridBitmap& bitmap, int node) {
+			labels[node] = -1;
+
+			int sides[4];
+			int side_count = ringSides(bitmap, node, sides);
+			if (side_count > 1)
+				separate(bitmap, sides, side_count);
+
+			// splits keep adding labels, start over before they outgrow the grid
+			if (label_parents.size() > 2 * labels.size() + 64)
+				rebuild(bitmap);
+		}
+
+	private:
+		static bool passable(const GridBitmap& bitmap, int x, int y) {
+			return x >= 0 && x < bitmap.width() && y >= 0 && y < bitmap.height() && bitmap.test(x, y);
+		}
+
+		template <class Fn>
+		static void forEachPassableNeighbour(const GridBitmap& bitmap, int node, Fn&& fn) {
+			int w = bitmap.width();
+			int x = node % w;
+			int y = node / w;
+			if (passable(bitmap, x - 1, y))
+				fn(node - 1);
+			if (passable(bitmap, x + 1, y))
+				fn(node + 1);
+			if (passable(bitmap, x, y - 1))
+				fn(node - w);
+			if (passable(bitmap, x, y + 1))
+				fn(node + w);
+		}
+
+		/*
+		* Queries only read, the updates below compress the paths they walk.
+		*/
+		int root(int label) const {
+			while (label_parents[label] != label)
+				label = label_parents[label];
+			return label;
+		}
+
+		int find(int label) {
+			while (label_parents[label] != label) {
+				label_parents[label] = label_parents[label_parents[label]];
+				label = label_parents[label];
+			}
+			return label;
+		}
+
+		void unite(int a, int b) {
+			a = find(a);
+			b = find(b);
+			if (a != b)
+				label_parents[std::max(a, b)] = std::min(a, b);
+		}
+
+		int freshLabel() {
+			label_parents.push_back(static_cast<int>(label_parents.size()));
+			return label_parents.back();
+		}
+
+		/*
+		* One passable neighbour of node per run of passable cells on the ring
+		* of eight around it. Neighbours in the same run stay connected without
+		* node, so only more than one run can mean a split.
+		*/
+		int ringSides(const GridBitmap& bitmap, int node, int* sides) const {
+			int w = bitmap.width();
+			int x = node % w;
+			int y = node / w;
+
+			// clockwise from the top, even positions are the four neighbours
+			static constexpr int k_ring_x[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+			static constexpr int k_ring_y[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+			bool open[8];
+			for (int i = 0; i < 8; i++)
+				open[i] = passable(bitmap, x + k_ring_x[i], y + k_ring_y[i]);
+
+			// start right after a blocked cell so no run wraps around
+			int first = 0;
+			while (first < 8 && open[first])
+				first++;
+			if (first == 8)
+				return 1;
+
+			int count = 0;
+			bool run_has_side = false;
+			for (int k = 1; k <= 8; k++) {
+				int i = (first + k) % 8;
+				if (!open[i]) {
+					run_has_side = false;
+					continue;
+				}
+				if (i % 2 == 0 && !run_has_side) {
+					sides[count++] = (x + k_ring_x[i]) + (y + k_ring_y[i]) * w;
+					run_has_side = true;
+				}
+			}
+			return count;
+		}
+
+		/*
+		* Breadth first searches from every side in lockstep. Sides that meet
+		* are merged; a merged group whose searches all run out is a component
+		* of its own and gets a new label. Stops when one group is left, which
+		* keeps the old label.
+		*/
+		void separate(const GridBitmap& bitmap, const int* sides, int side_count) {
+			if (++generation == 0) {
+				std::fill(stamps.begin(), stamps.end(), 0);
+				generation = 1;
+			}
+
+			struct Side {
+				std::vector<int> visited;
+				size_t head = 0;
+				int group;
+			};
+			Side searches[4];
+			int groups[4];
+			int live_groups = side_count;
+
+			for (int i = 0; i < side_count; i++) {
+				searches[i].visited.push_back(sides[i]);
+				searches[i].group = i;
+				groups[i] = i;
+				stamps[sides[i]] = generation;
+				stamp_groups[sides[i]] = static_cast<std::int8_t>(i);
+			}
+
+			auto group = [&](int i) {
+				while (groups[i] != i)
+					i = groups[i];
+				return i;
+			};
+			auto exhausted = [&](int g) {
+				for (int i = 0; i < side_count; i++)
+					if (group(i) == g && searches[i].head < searches[i].visited.size())
+						return false;
+				return true;
+			};
+
+			std::vector<bool> finished(side_count, false);
+			while (live_groups > 1) {
+				for (int i = 0; i < side_count && live_groups > 1; i++) {
+					Side& search = searches[i];
+					int g = group(i);
+					if (finished[g] || search.head == search.visited.size())
+						continue;
+
+					int node = search.visited[search.head++];
+					forEachPassableNeighbour(bitmap, node, [&](int next_node) {
+						if (stamps[next_node] != generation) {
+							stamps[next_node] = generation;
+							stamp_groups[next_node] = static_cast<std::int8_t>(i);
+							search.visited.push_back(next_node);
+							return;
+						}
+						int other = group(stamp_groups[next_node]);
+						if (other != group(i)) {
+							groups[std::max(other, group(i))] = std::min(other, group(i));
+							live_groups--;
+						}
+					});
+
+					g = group(i);
+					if (live_groups > 1 && exhausted(g)) {
+						int label = freshLabel();
+						for (int j = 0; j < side_count; j++) {
+							if (group(j) != g)
+								continue;
+							for (int cell : searches[j].visited)
+								labels[cell] = label;
+						}
+						finished[g] = true;
+						live_groups--;
+					}
+				}
+			}
+		}
+
+	private:
+		std::vector<int> labels;
+		std::vector<int> label_parents;
+
+		// scratch for separate(): which side reached a cell in this generation
+		std::vector<std::uint32_t> stamps;
+		std::vector<std::int8_t> stamp_groups;
+		std::uint32_t generation = 0;
+	};
+};
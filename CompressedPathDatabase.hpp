@@ -0,0 +1,322 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <algorithm>
+
+#include "Search.hpp"
+#include "Parallel.hpp"
+#include "NodeOrder.hpp"
+#include "MappedFile.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * First move of a shortest path between any two nodes, without search.
+	 *
+	 * For every source the database keeps the first move towards every
+	 * target: on a grid the direction of the neighbour to step to, decoded
+	 * through the graph's node order, otherwise its rank among the
+	 * neighbours by node id. Neither depends on the order forEachNeighbour
+	 * visits them in, which disconnecting and reconnecting an edge may
+	 * change. Targets are numbered in depth first order, which keeps nearby
+	 * nodes together, and nearby targets are mostly reached through the same
+	 * neighbour: each row is stored as runs of equal moves, found by binary
+	 * search. The source itself matches any move and never starts a run.
+	 *
+	 * Rows are computed in parallel, one search per source, so building is
+	 * quadratic and meant for fixed maps of moderate size; runs address at
+	 * most 2^24 nodes and nodes have at most 255 neighbours. A saved
+	 * database is opened memory mapped, loading only the rows queried.
+	 */
+	class CompressedPathDatabase {
+	public:
+		struct Statistics {
+			int nodes;
+			std::size_t runs;
+			// ranks, row offsets and runs
+			std::size_t bytes;
+			// 0 for a database opened from disk
+			double build_milliseconds;
+		};
+
+		CompressedPathDatabase() = default;
+
+		template <class Graph>
+		CompressedPathDatabase(const Graph& graph, int threads = 0) {
+			build(graph, threads);
+		}
+
+		// the views point into the owned arrays or the mapping
+		CompressedPathDatabase(const CompressedPathDatabase&) = delete;
+		CompressedPathDatabase& operator=(const CompressedPathDatabase&) = delete;
+		CompressedPathDatabase(CompressedPathDatabase&&) = default;
+		CompressedPathDatabase& operator=(CompressedPathDatabase&&) = default;
+
+	public:
+		/*
+		* threads = 0 uses one thread per hardware thread.
+		*/
+		template <class Graph>
+		void build(const Graph& graph, int threads = 0) {
+			auto started = std::chrono::steady_clock::now();
+			int size = graph.size();
+			assert(size < 1 << 24 && "runs address at most 2^24 nodes");
+			mapping.reset();
+			owned_ranks = depthFirstRanks(graph);
+			owned_offsets.assign(1, 0);
+			owned_runs.clear();
+			std::vector<int> order(size);
+			for (int node = 0; node < size; node++)
+				order[owned_ranks[node]] = node;
+
+			std::vector<std::vector<std::uint32_t>> rows(size);
+			std::vector<FirstMoves> scratch(workerCount(threads));
+			parallelFor(static_cast<int>(scratch.size()), size, [&](int thread, int source) {
+				FirstMoves& first_moves = scratch[thread];
+				firstMoves(graph, source, first_moves);
+				encodeRow(first_moves.moves, order, source, rows[source]);
+			});
+
+			for (std::vector<std::uint32_t>& row : rows) {
+				owned_runs.insert(owned_runs.end(), row.begin(), row.end());
+				owned_offsets.push_back(owned_runs.size());
+				std::vector<std::uint32_t>().swap(row);
+			}
+			ranks = owned_ranks;
+			offsets = owned_offsets;
+			runs = owned_runs;
+			build_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+		}
+
+		int size() const {
+			return static_cast<int>(ranks.size());
+		}
+
+		/*
+		* The move from source, as described above, that starts a shortest
+		* path to target. -1 when target is source or cannot be reached.
+		*/
+		int firstMove(int source, int target) const {
+			if (source == target)
+				return -1;
+			auto begin = runs.begin() + offsets[source];
+			auto end = runs.begin() + offsets[source + 1];
+			std::uint32_t key = ranks[target] << 8 | k_no_move;
+			auto run = std::upper_bound(begin, end, key);
+			if (run == begin)
+				return -1;
+			std::uint32_t move = *(run - 1) & 0xff;
+			return move == k_no_move ? -1 : static_cast<int>(move);
+		}
+
+		/*
+		* The neighbour of source on a shortest path to target, -1 as above.
+		*/
+		template <class Graph>
+		int nextNode(const Graph& graph, int source, int target) const {
+			int move = firstMove(source, target);
+			int next = -1;
+			if (move != -1) {
+				graph.forEachNeighbour(source, [&](int next_node) {
+					if (moveTo(graph, source, next_node) == move)
+						next = next_node;
+				});
+			}
+			return next;
+		}
+
+		/*
+		* Follows first moves from start to end, one lookup per cell.
+		* Nullopt as well when the graph changed since the build and the
+		* moves no longer lead to end: a walk longer than size() cells went
+		* around in a cycle.
+		*/
+		template <class Graph>
+		std::optional<std::vector<int>> path(const Graph& graph, int start, int end) const {
+			std::vector<int> path{ start };
+			for (int node = start; node != end; ) {
+				node = nextNode(graph, node, end);
+				if (node == -1 || static_cast<int>(path.size()) == size())
+					return std::nullopt;
+				path.push_back(node);
+			}
+			return path;
+		}
+
+		Statistics statistics() const {
+			std::size_t bytes = ranks.size_bytes() + offsets.size_bytes() + runs.size_bytes();
+			return { size(), runs.size(), bytes, build_milliseconds };
+		}
+
+		/*
+		* Writes the database in the layout open() maps, native byte order.
+		*/
+		bool save(const std::string& path) const {
+			std::ofstream out(path, std::ios::binary);
+			Header header{ k_magic, k_version, static_cast<std::uint32_t>(size()), 0, runs.size() };
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(ranks.data()), ranks.size_bytes());
+			std::uint32_t padding = 0;
+			out.write(reinterpret_cast<const char*>(&padding), offsetsPosition(size()) - sizeof(header) - ranks.size_bytes());
+			out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size_bytes());
+			out.write(reinterpret_cast<const char*>(runs.data()), runs.size_bytes());
+			return static_cast<bool>(out);
+		}
+
+		/*
+		* Maps a database written by save(). Nullopt when the file is missing,
+		* truncated or was written by another version.
+		*/
+		static std::optional<CompressedPathDatabase> open(const std::string& path) {
+			std::optional<MappedFile> file = MappedFile::open(path);
+			if (!file || file->size() < sizeof(Header))
+				return std::nullopt;
+
+			Header header{};
+			std::memcpy(&header, file->data(), sizeof(header));
+			if (header.magic != k_magic || header.version != k_version)
+				return std::nullopt;
+			std::size_t nodes = header.nodes;
+			std::size_t runs_position = offsetsPosition(nodes) + (nodes + 1) * sizeof(std::uint64_t);
+			if (file->size() != runs_position + header.runs * sizeof(std::uint32_t))
+				return std::nullopt;
+
+			CompressedPathDatabase database{};
+			const std::byte* data = file->data();
+			database.ranks = { reinterpret_cast<const std::uint32_t*>(data + sizeof(Header)), nodes };
+			database.offsets = { reinterpret_cast<const std::uint64_t*>(data + offsetsPosition(nodes)), nodes + 1 };
+			database.runs = { reinterpret_cast<const std::uint32_t*>(data + runs_position), header.runs };
+			if (database.offsets.front() != 0 || database.offsets.back() != header.runs
+				|| !std::is_sorted(database.offsets.begin(), database.offsets.end()))
+				return std::nullopt;
+			database.mapping = std::move(file);
+			return database;
+		}
+
+	private:
+		static constexpr std::uint32_t k_magic = 0x44504344; // "DCPD"
+		static constexpr std::uint32_t k_version = 2;
+		static constexpr std::uint8_t k_no_move = 0xff;
+
+		struct Header {
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint32_t nodes;
+			std::uint32_t reserved;
+			std::uint64_t runs;
+		};
+
+		/*
+		* Per thread state of the searches building the rows.
+		*/
+		struct FirstMoves {
+			std::vector<std::uint8_t> moves;
+			SingleSourceTree tree;
+		};
+
+		/*
+		* Row offsets follow the ranks, aligned for 64 bit reads.
+		*/
+		static std::size_t offsetsPosition(std::size_t nodes) {
+			std::size_t position = sizeof(Header) + nodes * sizeof(std::uint32_t);
+			return (position + 7) & ~std::size_t{ 7 };
+		}
+
+		template <class Graph>
+		static std::vector<std::uint32_t> depthFirstRanks(const Graph& graph) {
+			std::vector<std::uint32_t> ranks(graph.size(), UINT32_MAX);
+			std::uint32_t rank = 0;
+			std::vector<int> stack{};
+			for (int root = 0; root < graph.size(); root++) {
+				stack.push_back(root);
+				while (!stack.empty()) {
+					int node = stack.back();
+					stack.pop_back();
+					if (ranks[node] != UINT32_MAX)
+						continue;
+					ranks[node] = rank++;
+					graph.forEachNeighbour(node, [&](int next_node) {
+						if (ranks[next_node] == UINT32_MAX)
+							stack.push_back(next_node);
+					});
+				}
+			}
+			return ranks;
+		}
+
+		/*
+		* The move from node to its neighbour next_node: left, right, up or
+		* down on a grid, the number of neighbours with smaller ids otherwise.
+		*/
+		template <class Graph>
+		static int moveTo(const Graph& graph, int node, int next_node) {
+			if (graph.width() > 0) {
+				auto order = gridOrder(graph);
+				int dx = order.x(next_node) - order.x(node);
+				int dy = order.y(next_node) - order.y(node);
+				return dx < 0 ? 0 : dx > 0 ? 1 : dy < 0 ? 2 : 3;
+			}
+			int move = 0;
+			graph.forEachNeighbour(node, [&](int other) {
+				move += other < next_node;
+			});
+			return move;
+		}
+
+		/*
+		* Every node inherits the first move of its parent in the shortest path
+		* tree from source, the source's children start them.
+		*/
+		template <class Graph>
+		static void firstMoves(const Graph& graph, int source, FirstMoves& state) {
+			singleSourceTree(graph, source, state.tree);
+			std::vector<std::uint8_t>& moves = state.moves;
+			moves.assign(graph.size(), k_no_move);
+			for (int node : state.tree.order) {
+				int parent = state.tree.parents[node];
+				if (parent == source) {
+					int move = moveTo(graph, source, node);
+					assert(move < k_no_move && "nodes have at most 255 neighbours");
+					moves[node] = static_cast<std::uint8_t>(move);
+				}
+				else if (parent != -1) {
+					moves[node] = moves[parent];
+				}
+			}
+		}
+
+		/*
+		* Runs of equal moves in rank order, packed as rank << 8 | move.
+		*/
+		static void encodeRow(const std::vector<std::uint8_t>& moves, const std::vector<int>& order, int source, std::vector<std::uint32_t>& row) {
+			for (std::uint32_t rank = 0; rank < order.size(); rank++) {
+				int node = order[rank];
+				if (node == source)
+					continue;
+				if (row.empty())
+					row.push_back(moves[node]);
+				else if ((row.back() & 0xff) != moves[node])
+					row.push_back(rank << 8 | moves[node]);
+			}
+		}
+
+	private:
+		std::span<const std::uint32_t> ranks;
+		std::span<const std::uint64_t> offsets;
+		std::span<const std::uint32_t> runs;
+		double build_milliseconds = 0;
+
+		std::vector<std::uint32_t> owned_ranks;
+		std::vector<std::uint64_t> owned_offsets;
+		std::vector<std::uint32_t> owned_runs;
+		std::optional<MappedFile> mapping;
+	};
+};
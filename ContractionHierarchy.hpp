@@ -0,0 +1,553 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <istream>
+#include <ostream>
+#include <optional>
+#include <algorithm>
+
+#include "Search.hpp"
+#include "SearchWorkspace.hpp"
+#include "PriorityQueue.hpp"
+#include "Parallel.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Contraction Hierarchies for graphs that stop changing once generated.
+	 *
+	 * Preprocessing removes the nodes one at a time, least important first,
+	 * and adds a shortcut u -> w for every u -> v -> w through the removed v
+	 * that no other path ("witness") beats. Importance is the edge difference
+	 * (shortcuts added minus arcs removed) plus the number of neighbours
+	 * already removed, which spreads the contraction evenly. Every round
+	 * takes the nodes that are less important than all their neighbours, an
+	 * independent set, and contracts them together on several threads.
+	 *
+	 * Every arc then leads from a node to a more important one, forwards
+	 * from a contracted node or backwards into it. A query searches upwards
+	 * from both ends and meets at the most important node of the shortest
+	 * path, settling only a few hundred nodes even on large grids. Shortcuts
+	 * remember the node they skip, so paths unpack back into cells.
+	 *
+	 * The hierarchy keeps no reference to the graph; save() and load() write
+	 * and read it as raw binary, for the same platform only.
+	 */
+	class ContractionHierarchy {
+	public:
+		ContractionHierarchy() = default;
+
+		template <class Graph>
+		ContractionHierarchy(const Graph& graph, int threads = 0) {
+			build(graph, threads);
+		}
+
+	public:
+		/*
+		* threads = 0 uses one thread per hardware thread.
+		*/
+		template <class Graph>
+		void build(const Graph& graph, int threads = 0) {
+			Contraction contraction(graph.size(), workerCount(threads));
+			for (int node = 0; node < graph.size(); node++) {
+				graph.forEachNeighbour(node, [&](int next_node) {
+					contraction.outgoing[node].push_back({ next_node, stepCost(graph, next_node), -1 });
+					contraction.incoming[next_node].push_back({ node, stepCost(graph, next_node), -1 });
+				});
+			}
+			contract(contraction);
+		}
+
+		int size() const {
+			return static_cast<int>(upward_offsets.empty() ? 0 : upward_offsets.size() - 1);
+		}
+
+		/*
+		* Arcs of the hierarchy, original arcs and shortcuts, both directions.
+		*/
+		int arcCount() const {
+			return static_cast<int>(upward.size() + downward.size());
+		}
+
+		std::optional<int> distance(int start, int end) {
+			if (start == end)
+				return 0;
+			int meeting = search(start, end);
+			if (meeting == -1)
+				return std::nullopt;
+			return workspace.distance(meeting, k_up) + workspace.distance(meeting, k_down);
+		}
+
+		std::optional<std::vector<int>> findPath(int start, int end) {
+			if (start == end)
+				return std::vector<int>{ start };
+			int meeting = search(start, end);
+			if (meeting == -1)
+				return std::nullopt;
+
+			// hierarchy nodes from start up to the meeting node and down to end
+			std::vector<int> nodes{};
+			for (int node = meeting; node != -1; node = workspace.parent(node, k_up))
+				nodes.push_back(node);
+			std::reverse(nodes.begin(), nodes.end());
+			size_t climbed = nodes.size();
+			for (int node = workspace.parent(meeting, k_down); node != -1; node = workspace.parent(node, k_down))
+				nodes.push_back(node);
+
+			std::vector<int> path{ start };
+			for (size_t i = 1; i < nodes.size(); i++) {
+				int from = nodes[i - 1];
+				int to = nodes[i];
+				// the arc was recorded at the node reached through it
+				int middle = i < climbed ? middles[k_up][to] : middles[k_down][from];
+				if (!unpack(from, to, middle, path))
+					return std::nullopt;
+			}
+			return path;
+		}
+
+		void save(std::ostream& out) const {
+			write(out, k_magic);
+			write(out, k_version);
+			writeArray(out, upward_offsets);
+			writeArray(out, upward);
+			writeArray(out, downward_offsets);
+			writeArray(out, downward);
+		}
+
+		/*
+		* False, leaving the hierarchy empty, when the stream does not hold a
+		* hierarchy written by this version.
+		*/
+		bool load(std::istream& in) {
+			std::uint32_t magic = 0;
+			std::uint32_t version = 0;
+			bool loaded = read(in, magic) && magic == k_magic && read(in, version) && version == k_version
+				&& readArray(in, upward_offsets) && readArray(in, upward)
+				&& readArray(in, downward_offsets) && readArray(in, downward)
+				&& upward_offsets.size() == downward_offsets.size()
+				&& consistent(upward_offsets, upward) && consistent(downward_offsets, downward);
+			if (!loaded) {
+				upward_offsets.clear();
+				upward.clear();
+				downward_offsets.clear();
+				downward.clear();
+			}
+			return loaded;
+		}
+
+	private:
+		enum { k_up = SearchWorkspace::k_forward, k_down = SearchWorkspace::k_backward };
+
+		static constexpr std::uint32_t k_magic = 0x48434a44; // "DJCH"
+		static constexpr std::uint32_t k_version = 1;
+
+		// witness searches give up after this many nodes and keep the shortcut
+		static constexpr int k_witness_settle_limit = 500;
+
+		struct Arc {
+			int node;
+			int cost;
+			// node skipped by a shortcut, -1 for an arc of the graph
+			int middle;
+		};
+
+		struct Shortcut {
+			int from;
+			int to;
+			int cost;
+			int middle;
+		};
+
+		/*
+		* Per thread state of the witness searches.
+		*/
+		struct WitnessSearch {
+			std::vector<int> distances;
+			std::vector<std::int8_t> targets;
+			std::vector<int> touched;
+			BinaryHeap heap;
+		};
+
+		/*
+		* State that only lives while contracting: the remaining graph, with
+		* arcs to removed nodes dropped as they go.
+		*/
+		struct Contraction {
+			Contraction(int size, int threads)
+				:outgoing(size), incoming(size), priorities(size), removed_neighbours(size), contracted(size, false), searches(threads) {
+				for (WitnessSearch& search : searches) {
+					search.distances.assign(size, INT_MAX);
+					search.targets.assign(size, 0);
+				}
+			}
+
+			std::vector<std::vector<Arc>> outgoing;
+			std::vector<std::vector<Arc>> incoming;
+			std::vector<int> priorities;
+			std::vector<int> removed_neighbours;
+			std::vector<bool> contracted;
+			std::vector<WitnessSearch> searches;
+		};
+
+		/*
+		* Dijkstra from source over the remaining graph without skipped, until
+		* every marked target is settled, limit is passed or
+		* k_witness_settle_limit nodes are settled.
+		*/
+		static void witnessSearch(const Contraction& contraction, WitnessSearch& search, int source, int skipped, int limit, int targets) {
+			for (int node : search.touched)
+				search.distances[node] = INT_MAX;
+			search.touched.clear();
+			search.heap.clear();
+
+			search.distances[source] = 0;
+			search.touched.push_back(source);
+			search.heap.push(BinaryHeap::key(0, 0), source);
+
+			for (int settled = 0; !search.heap.empty() && settled < k_witness_settle_limit && targets > 0; settled++) {
+				auto [key, node] = search.heap.pop();
+				int distance = search.distances[node];
+				if (keyPrimary(key) > distance)
+					continue;
+				if (distance > limit)
+					break;
+				targets -= search.targets[node];
+
+				for (const Arc& arc : contraction.outgoing[node]) {
+					if (arc.node == skipped || contraction.contracted[arc.node])
+						continue;
+					int next_distance = distance + arc.cost;
+					if (next_distance < search.distances[arc.node]) {
+						if (search.distances[arc.node] == INT_MAX)
+							search.touched.push_back(arc.node);
+						search.distances[arc.node] = next_distance;
+						search.heap.push(BinaryHeap::key(next_distance, 0), arc.node);
+					}
+				}
+			}
+		}
+
+		/*
+		* Shortcuts needed to remove node from the remaining graph.
+		*/
+		template <class Emit>
+		static void shortcuts(const Contraction& contraction, WitnessSearch& search, int node, Emit&& emit) {
+			int longest_out = 0;
+			int targets = 0;
+			for (const Arc& out : contraction.outgoing[node]) {
+				if (contraction.contracted[out.node])
+					continue;
+				longest_out = std::max(longest_out, out.cost);
+				search.targets[out.node] = 1;
+				targets++;
+			}
+
+			for (const Arc& in : contraction.incoming[node]) {
+				if (contraction.contracted[in.node])
+					continue;
+				// in.node is a target of its own search only through node, settled at once
+				witnessSearch(contraction, search, in.node, node, in.cost + longest_out, targets);
+
+				for (const Arc& out : contraction.outgoing[node]) {
+					if (out.node == in.node || contraction.contracted[out.node])
+						continue;
+					if (search.distances[out.node] > in.cost + out.cost)
+						emit(Shortcut{ in.node, out.node, in.cost + out.cost, node });
+				}
+			}
+
+			for (const Arc& out : contraction.outgoing[node])
+				search.targets[out.node] = 0;
+		}
+
+		static int priority(const Contraction& contraction, WitnessSearch& search, int node) {
+			int added = 0;
+			shortcuts(contraction, search, node, [&](const Shortcut&) { added++; });
+			int removed = 0;
+			for (const Arc& arc : contraction.outgoing[node])
+				removed += !contraction.contracted[arc.node];
+			for (const Arc& arc : contraction.incoming[node])
+				removed += !contraction.contracted[arc.node];
+			return added - removed + contraction.removed_neighbours[node];
+		}
+
+		/*
+		* Less important than every remaining neighbour, ties to the lower id.
+		*/
+		static bool locallyMinimal(const Contraction& contraction, int node) {
+			auto before = [&](int other) {
+				int a = contraction.priorities[node];
+				int b = contraction.priorities[other];
+				return a < b || (a == b && node < other);
+			};
+			for (const Arc& arc : contraction.outgoing[node])
+				if (!contraction.contracted[arc.node] && !before(arc.node))
+					return false;
+			for (const Arc& arc : contraction.incoming[node])
+				if (!contraction.contracted[arc.node] && !before(arc.node))
+					return false;
+			return true;
+		}
+
+		static void addArc(std::vector<Arc>& arcs, Arc arc) {
+			for (Arc& existing : arcs) {
+				if (existing.node == arc.node) {
+					if (arc.cost < existing.cost)
+						existing = arc;
+					return;
+				}
+			}
+			arcs.push_back(arc);
+		}
+
+		static void dropArc(std::vector<Arc>& arcs, int node) {
+			for (size_t i = 0; i < arcs.size(); i++) {
+				if (arcs[i].node == node) {
+					arcs[i] = arcs.back();
+					arcs.pop_back();
+					return;
+				}
+			}
+		}
+
+		void contract(Contraction& contraction) {
+			int size = static_cast<int>(contraction.outgoing.size());
+			int threads = static_cast<int>(contraction.searches.size());
+			std::vector<std::vector<Arc>> ups(size);
+			std::vector<std::vector<Arc>> downs(size);
+
+			parallelFor(threads, size, [&](int thread, int node) {
+				contraction.priorities[node] = priority(contraction, contraction.searches[thread], node);
+			});
+
+			std::vector<int> remaining(size);
+			for (int node = 0; node < size; node++)
+				remaining[node] = node;
+
+			while (!remaining.empty()) {
+				std::vector<int> batch{};
+				for (int node : remaining)
+					if (locallyMinimal(contraction, node))
+						batch.push_back(node);
+
+				// witnesses may not pass through the batch: each of its nodes is gone for the others
+				for (int node : batch)
+					contraction.contracted[node] = true;
+				std::vector<std::vector<Shortcut>> added(batch.size());
+				parallelFor(threads, static_cast<int>(batch.size()), [&](int thread, int i) {
+					shortcuts(contraction, contraction.searches[thread], batch[i], [&](const Shortcut& shortcut) {
+						added[i].push_back(shortcut);
+					});
+				});
+
+				std::vector<int> neighbours{};
+				for (size_t i = 0; i < batch.size(); i++) {
+					int node = batch[i];
+					ups[node] = contraction.outgoing[node];
+					downs[node] = contraction.incoming[node];
+					for (const Arc& arc : contraction.outgoing[node]) {
+						dropArc(contraction.incoming[arc.node], node);
+						contraction.removed_neighbours[arc.node]++;
+						neighbours.push_back(arc.node);
+					}
+					for (const Arc& arc : contraction.incoming[node]) {
+						dropArc(contraction.outgoing[arc.node], node);
+						contraction.removed_neighbours[arc.node]++;
+						neighbours.push_back(arc.node);
+					}
+					for (const Shortcut& shortcut : added[i]) {
+						addArc(contraction.outgoing[shortcut.from], { shortcut.to, shortcut.cost, shortcut.middle });
+						addArc(contraction.incoming[shortcut.to], { shortcut.from, shortcut.cost, shortcut.middle });
+					}
+					std::vector<Arc>().swap(contraction.outgoing[node]);
+					std::vector<Arc>().swap(contraction.incoming[node]);
+				}
+
+				std::sort(neighbours.begin(), neighbours.end());
+				neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+				parallelFor(threads, static_cast<int>(neighbours.size()), [&](int thread, int i) {
+					contraction.priorities[neighbours[i]] = priority(contraction, contraction.searches[thread], neighbours[i]);
+				});
+
+				remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](int node) {
+					return contraction.contracted[node];
+				}), remaining.end());
+			}
+
+			flatten(ups, upward_offsets, upward);
+			flatten(downs, downward_offsets, downward);
+		}
+
+		static void flatten(const std::vector<std::vector<Arc>>& lists, std::vector<int>& offsets, std::vector<Arc>& arcs) {
+			offsets.assign(1, 0);
+			arcs.clear();
+			for (const std::vector<Arc>& list : lists) {
+				arcs.insert(arcs.end(), list.begin(), list.end());
+				offsets.push_back(static_cast<int>(arcs.size()));
+			}
+		}
+
+		/*
+		* Bidirectional Dijkstra upwards from both ends, stopped once neither
+		* queue can beat the best meeting found. Returns the meeting node.
+		*/
+		int search(int start, int end) {
+			workspace.reset(size());
+			for (std::vector<int>& side_middles : middles)
+				side_middles.resize(size());
+			heaps[k_up].clear();
+			heaps[k_down].clear();
+
+			int best = INT_MAX;
+			int meeting = -1;
+			workspace.update(start, 0, -1, k_up);
+			workspace.update(end, 0, -1, k_down);
+			heaps[k_up].push(BinaryHeap::key(0, 0), start);
+			heaps[k_down].push(BinaryHeap::key(0, 0), end);
+
+			for (int side = k_up; ; side ^= 1) {
+				if (heaps[side].empty())
+					side ^= 1;
+				if (heaps[side].empty())
+					break;
+
+				auto [key, node] = heaps[side].pop();
+				int distance = workspace.distance(node, side);
+				if (keyPrimary(key) > distance)
+					continue;
+				if (distance >= best) {
+					// this side cannot improve anymore
+					heaps[side].clear();
+					continue;
+				}
+
+				if (workspace.reached(node, side ^ 1) && distance + workspace.distance(node, side ^ 1) < best) {
+					best = distance + workspace.distance(node, side ^ 1);
+					meeting = node;
+				}
+
+				const std::vector<Arc>& arcs = side == k_up ? upward : downward;
+				const std::vector<int>& offsets = side == k_up ? upward_offsets : downward_offsets;
+				if (stalled(node, distance, side))
+					continue;
+				for (int i = offsets[node]; i < offsets[node + 1]; i++) {
+					const Arc& arc = arcs[i];
+					if (distance + arc.cost < workspace.distance(arc.node, side)) {
+						workspace.update(arc.node, distance + arc.cost, node, side);
+						middles[side][arc.node] = arc.middle;
+						heaps[side].push(BinaryHeap::key(distance + arc.cost, 0), arc.node);
+					}
+				}
+			}
+			return meeting;
+		}
+
+		/*
+		* Stall on demand: a more important node already reached by this side
+		* leads to node more cheaply, so no shortest path climbs through it.
+		*/
+		bool stalled(int node, int distance, int side) const {
+			const std::vector<Arc>& arcs = side == k_up ? downward : upward;
+			const std::vector<int>& offsets = side == k_up ? downward_offsets : upward_offsets;
+			for (int i = offsets[node]; i < offsets[node + 1]; i++) {
+				int other = workspace.distance(arcs[i].node, side);
+				if (other != INT_MAX && other + arcs[i].cost < distance)
+					return true;
+			}
+			return false;
+		}
+
+		/*
+		* Appends the cells after from up to to for an arc of the hierarchy.
+		* A shortcut from -> to over middle is from -> middle, stored with
+		* middle's downward arcs, then middle -> to with its upward arcs.
+		* False when a shortcut has no such half, which a hierarchy built here
+		* never has but a loaded one can.
+		*/
+		bool unpack(int from, int to, int middle, std::vector<int>& path) const {
+			struct Pending {
+				int from;
+				int to;
+				int middle;
+			};
+			std::vector<Pending> stack{ { from, to, middle } };
+			while (!stack.empty()) {
+				Pending arc = stack.back();
+				stack.pop_back();
+				if (arc.middle == -1) {
+					path.push_back(arc.to);
+					continue;
+				}
+				const Arc* second = findArc(upward_offsets, upward, arc.middle, arc.to);
+				const Arc* first = findArc(downward_offsets, downward, arc.middle, arc.from);
+				if (!first || !second)
+					return false;
+				// second half first, the stack pops the first half before it
+				stack.push_back({ arc.middle, arc.to, second->middle });
+				stack.push_back({ arc.from, arc.middle, first->middle });
+			}
+			return true;
+		}
+
+		/*
+		* The arc of node towards other, nullptr when there is none.
+		*/
+		static const Arc* findArc(const std::vector<int>& offsets, const std::vector<Arc>& arcs, int node, int other) {
+			const Arc* found = nullptr;
+			for (int i = offsets[node]; i < offsets[node + 1]; i++)
+				if (arcs[i].node == other)
+					found = &arcs[i];
+			return found;
+		}
+
+		bool consistent(const std::vector<int>& offsets, const std::vector<Arc>& arcs) const {
+			if (offsets.empty() || offsets.front() != 0 || offsets.back() != static_cast<int>(arcs.size()))
+				return false;
+			if (!std::is_sorted(offsets.begin(), offsets.end()))
+				return false;
+			return std::all_of(arcs.begin(), arcs.end(), [&](const Arc& arc) {
+				return arc.node >= 0 && arc.node < size() && arc.middle >= -1 && arc.middle < size();
+			});
+		}
+
+		template <class T>
+		static void write(std::ostream& out, const T& value) {
+			out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		template <class T>
+		static bool read(std::istream& in, T& value) {
+			return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+		}
+
+		template <class T>
+		static void writeArray(std::ostream& out, const std::vector<T>& values) {
+			write(out, static_cast<std::uint64_t>(values.size()));
+			out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+		}
+
+		template <class T>
+		static bool readArray(std::istream& in, std::vector<T>& values) {
+			std::uint64_t count = 0;
+			if (!read(in, count) || count > (1ull << 34) / sizeof(T))
+				return false;
+			values.resize(count);
+			return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), count * sizeof(T)));
+		}
+
+	private:
+		// upward[upward_offsets[v] ...]: arcs v -> more important nodes
+		std::vector<int> upward_offsets;
+		std::vector<Arc> upward;
+		// downward[downward_offsets[v] ...]: arcs into v from more important nodes
+		std::vector<int> downward_offsets;
+		std::vector<Arc> downward;
+
+		SearchWorkspace workspace;
+		BinaryHeap heaps[2];
+		std::vector<int> middles[2];
+	};
+};
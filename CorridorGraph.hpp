@@ -0,0 +1,361 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <optional>
+#include <algorithm>
+
+#include "Search.hpp"
+#include "SearchWorkspace.hpp"
+#include "AStar.hpp"
+#include "NodeOrder.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Searches a graph on its junctions only, with corridors contracted.
+	 *
+	 * Nodes with exactly two neighbours are corridor cells; every other node
+	 * is a junction (crossings, dead ends). Each maximal run of corridor cells
+	 * becomes one chain between the two junctions next to its ends, carrying
+	 * the prefix sums of its step costs. A* then runs on the junctions only,
+	 * a chain being one edge, and chains are expanded back into cells only
+	 * for the final path. A chain costs at least the Manhattan distance
+	 * between its ends, so the grid heuristic stays admissible. Starts and
+	 * ends inside a chain enter the search through both of its ends. A ring
+	 * without any junction gets one of its cells promoted to junction.
+	 *
+	 * The index reads the graph it was given, which must outlive it. After a
+	 * cell is toggled or changes cost call updateCell(): only the chains
+	 * through that cell and its grid neighbours are retraced.
+	 */
+	template <class Graph>
+	class CorridorGraph {
+		static_assert(RowMajorGrid<Graph>, "corridors decode node ids as row major cells");
+
+	public:
+		CorridorGraph(const Graph& graph)
+			:graph(graph) {
+			build();
+		}
+
+	public:
+		void build() {
+			kinds.assign(graph.size(), k_isolated);
+			chain_of.assign(graph.size(), -1);
+			chain_pos.assign(graph.size(), 0);
+			chains.clear();
+			free_chains.clear();
+
+			for (int node = 0; node < graph.size(); node++)
+				kinds[node] = classify(node);
+			for (int node = 0; node < graph.size(); node++)
+				if (kinds[node] == k_corridor && chain_of[node] == -1)
+					traceChain(node);
+		}
+
+		/*
+		* A grid cell was enabled, disabled or changed cost: retraces the chains
+		* through it and its four grid neighbours, and the chains ending there.
+		*/
+		void updateCell(int node) {
+			int w = graph.width();
+			int x = node % w;
+			int y = node / w;
+
+			std::vector<int> touched{ node };
+			if (x > 0)
+				touched.push_back(node - 1);
+			if (x < w - 1)
+				touched.push_back(node + 1);
+			if (y > 0)
+				touched.push_back(node - w);
+			if (y < graph.height() - 1)
+				touched.push_back(node + w);
+
+			size_t affected = touched.size();
+			for (size_t i = 0; i < affected; i++) {
+				int cell = touched[i];
+				dissolveChain(chain_of[cell], touched);
+				graph.forEachNeighbour(cell, [&](int next_node) {
+					dissolveChain(chain_of[next_node], touched);
+				});
+			}
+
+			for (int cell : touched)
+				kinds[cell] = classify(cell);
+			for (int cell : touched)
+				if (kinds[cell] == k_corridor && chain_of[cell] == -1)
+					traceChain(cell);
+		}
+
+		std::optional<std::vector<int>> findPath(int start, int end) {
+			if (start == end)
+				return std::vector<int>{ start };
+
+			search.reset(graph.size());
+			target = end;
+			best_distance = INT_MAX;
+			best_junction = -1;
+
+			if (kinds[start] == k_corridor) {
+				const Chain& chain = chains[chain_of[start]];
+				int i = chain_pos[start];
+				// towards a: the cells before start, then a
+				relax(chain.a, chain.prefix[i] - cellCost(start) + stepCost(graph, chain.a), chain.cells.front());
+				relax(chain.b, chain.prefix.back() - chain.prefix[i] + stepCost(graph, chain.b), chain.cells.back());
+
+				if (chain_of[end] == chain_of[start]) {
+					int j = chain_pos[end];
+					int direct = j > i ? chain.prefix[j] - chain.prefix[i] : chain.prefix[i] - cellCost(start) - chain.prefix[j] + cellCost(end);
+					best_distance = direct;
+				}
+			}
+			else {
+				relax(start, 0, -1);
+			}
+
+			while (!search.heapEmpty()) {
+				auto [key, node] = search.pop();
+				int distance = search.distance(node);
+				if (keyPrimary(key) > distance + estimate(node))
+					continue;
+				if (keyPrimary(key) >= best_distance)
+					break;
+
+				if (node == end) {
+					best_distance = distance;
+					best_junction = node;
+					break;
+				}
+				if (kinds[end] == k_corridor) {
+					const Chain& chain = chains[chain_of[end]];
+					int j = chain_pos[end];
+					if (node == chain.a && distance + chain.prefix[j] < best_distance) {
+						best_distance = distance + chain.prefix[j];
+						best_junction = node;
+						best_from_front = true;
+					}
+					if (node == chain.b && distance + chain.prefix.back() - chain.prefix[j] + cellCost(end) < best_distance) {
+						best_distance = distance + chain.prefix.back() - chain.prefix[j] + cellCost(end);
+						best_junction = node;
+						best_from_front = false;
+					}
+				}
+
+				graph.forEachNeighbour(node, [&](int next_node) {
+					if (kinds[next_node] != k_corridor) {
+						relax(next_node, distance + stepCost(graph, next_node), node);
+						return;
+					}
+					const Chain& chain = chains[chain_of[next_node]];
+					if (next_node == chain.cells.front() && node == chain.a)
+						relax(chain.b, distance + chain.prefix.back() + stepCost(graph, chain.b), chain.cells.back());
+					else
+						relax(chain.a, distance + chain.prefix.back() + stepCost(graph, chain.a), chain.cells.front());
+				});
+			}
+
+			if (best_distance == INT_MAX)
+				return std::nullopt;
+			return unpack(start, end);
+		}
+
+		/*
+		* Nodes the search runs on, for comparing against size().
+		*/
+		int junctionCount() const {
+			return static_cast<int>(std::count(kinds.begin(), kinds.end(), k_junction));
+		}
+
+		int chainCount() const {
+			return static_cast<int>(chains.size() - free_chains.size());
+		}
+
+	private:
+		enum : std::int8_t { k_isolated, k_junction, k_corridor };
+
+		struct Chain {
+			// junction next to cells.front() and next to cells.back()
+			int a;
+			int b;
+			std::vector<int> cells;
+			// prefix[i]: cost of entering cells 0 to i
+			std::vector<int> prefix;
+		};
+
+		std::int8_t classify(int node) const {
+			int degree = 0;
+			graph.forEachNeighbour(node, [&](int) { degree++; });
+			if (degree == 0)
+				return k_isolated;
+			return degree == 2 ? k_corridor : k_junction;
+		}
+
+		/*
+		* Manhattan distance to the target, 0 on graphs without grid geometry.
+		*/
+		int estimate(int node) const {
+			if (graph.width() <= 0)
+				return 0;
+			return ManhattanDistance{ graph.width() }(node, target);
+		}
+
+		int cellCost(int node) const {
+			return stepCost(graph, node);
+		}
+
+		/*
+		* Walks from node away from previous until the next junction, appending
+		* the corridor cells. Returns the junction, or -1 when the walk came
+		* back to stop: a ring without junctions.
+		*/
+		int walk(int previous, int node, int stop, std::vector<int>& cells) const {
+			while (kinds[node] == k_corridor) {
+				if (node == stop)
+					return -1;
+				cells.push_back(node);
+				int next = -1;
+				graph.forEachNeighbour(node, [&](int next_node) {
+					if (next_node != previous)
+						next = next_node;
+				});
+				previous = node;
+				node = next;
+			}
+			return node;
+		}
+
+		void traceChain(int node) {
+			int ends[2] = { -1, -1 };
+			int n = 0;
+			graph.forEachNeighbour(node, [&](int next_node) { ends[n++] = next_node; });
+
+			std::vector<int> before{};
+			int a = walk(node, ends[0], node, before);
+			if (a == -1) {
+				// promote a ring cell, the rest of the ring is a chain from it to itself
+				kinds[node] = k_junction;
+				if (kinds[ends[0]] == k_corridor)
+					traceChain(ends[0]);
+				return;
+			}
+			std::vector<int> after{};
+			int b = walk(node, ends[1], node, after);
+
+			int id;
+			if (free_chains.empty()) {
+				id = static_cast<int>(chains.size());
+				chains.emplace_back();
+			}
+			else {
+				id = free_chains.back();
+				free_chains.pop_back();
+			}
+
+			Chain& chain = chains[id];
+			chain.a = a;
+			chain.b = b;
+			chain.cells.assign(before.rbegin(), before.rend());
+			chain.cells.push_back(node);
+			chain.cells.insert(chain.cells.end(), after.begin(), after.end());
+			chain.prefix.resize(chain.cells.size());
+			int cost = 0;
+			for (size_t i = 0; i < chain.cells.size(); i++) {
+				int cell = chain.cells[i];
+				cost += cellCost(cell);
+				chain.prefix[i] = cost;
+				chain_of[cell] = id;
+				chain_pos[cell] = static_cast<int>(i);
+			}
+		}
+
+		void dissolveChain(int id, std::vector<int>& loose) {
+			if (id == -1)
+				return;
+			for (int cell : chains[id].cells) {
+				chain_of[cell] = -1;
+				loose.push_back(cell);
+			}
+			chains[id].cells.clear();
+			free_chains.push_back(id);
+		}
+
+		/*
+		* The parent of a junction is the cell just before it on the path, a
+		* junction or the last cell of the chain the path came through.
+		*/
+		void relax(int node, int distance, int parent) {
+			if (distance < search.distance(node)) {
+				int h = estimate(node);
+				search.update(node, distance, parent);
+				search.push(search.key(distance + h, h), node);
+			}
+		}
+
+		std::vector<int> unpack(int start, int end) const {
+			std::vector<int> path{};
+			int node = best_junction;
+
+			if (best_junction == -1) {
+				// start and end on the same chain, closer to each other than to either end
+				const Chain& chain = chains[chain_of[start]];
+				int step = chain_pos[end] > chain_pos[start] ? 1 : -1;
+				for (int i = chain_pos[start]; i != chain_pos[end] + step; i += step)
+					path.push_back(chain.cells[i]);
+				return path;
+			}
+
+			if (node != end) {
+				const Chain& chain = chains[chain_of[end]];
+				int step = best_from_front ? -1 : 1;
+				for (int i = chain_pos[end]; i >= 0 && i < static_cast<int>(chain.cells.size()); i += step)
+					path.push_back(chain.cells[i]);
+			}
+
+			while (node != start) {
+				path.push_back(node);
+				int parent = search.parent(node);
+				if (kinds[parent] != k_corridor) {
+					node = parent;
+					continue;
+				}
+
+				const Chain& chain = chains[chain_of[parent]];
+				// entered through the far end of the chain, walk it towards that end
+				bool from_front = parent == chain.cells.front() && node == chain.a;
+				int i = chain_pos[parent];
+				int step = from_front ? 1 : -1;
+				for (; i >= 0 && i < static_cast<int>(chain.cells.size()); i += step) {
+					path.push_back(chain.cells[i]);
+					if (chain.cells[i] == start)
+						break;
+				}
+				if (path.back() == start)
+					break;
+				node = from_front ? chain.b : chain.a;
+			}
+			if (path.back() != start)
+				path.push_back(start);
+
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+	private:
+		const Graph& graph;
+
+		std::vector<std::int8_t> kinds;
+		std::vector<int> chain_of;
+		std::vector<int> chain_pos;
+		std::vector<Chain> chains;
+		std::vector<int> free_chains;
+
+		SearchWorkspace search;
+		int target = -1;
+		int best_distance = INT_MAX;
+		int best_junction = -1;
+		bool best_from_front = false;
+	};
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <limits>
+
+#include "Random.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Cost of entering every cell, one small integer per cell.
+	 *
+	 * Nothing is allocated until a cell gets a cost other than 1, so unit cost
+	 * grids pay nothing. Costs start at 1, which keeps the Manhattan distance
+	 * admissible, and go up to the largest value of Cost (255 for uint8).
+	 */
+	template <class Cost = std::uint8_t>
+	class BasicCostMap {
+	public:
+		BasicCostMap(int size = 0)
+			:cells(size) {
+		}
+
+	public:
+		int size() const {
+			return cells;
+		}
+
+		int cost(int node) const {
+			return costs.empty() ? 1 : costs[node];
+		}
+
+		void setCost(int node, int cost) {
+			assert(cost >= 1 && cost <= maxCost());
+			if (costs.empty()) {
+				if (cost == 1)
+					return;
+				costs.assign(cells, 1);
+			}
+
+			non_unit_cells += (cost != 1) - (costs[node] != 1);
+			costs[node] = static_cast<Cost>(cost);
+		}
+
+		/*
+		* Every cell back to cost 1, releasing the array.
+		*/
+		void clear() {
+			costs.clear();
+			costs.shrink_to_fit();
+			non_unit_cells = 0;
+		}
+
+		/*
+		* True while every cell costs 1, searches can then ignore the costs.
+		*/
+		bool uniform() const {
+			return non_unit_cells == 0;
+		}
+
+		static int maxCost() {
+			return std::numeric_limits<Cost>::max();
+		}
+
+	private:
+		int cells;
+		int non_unit_cells = 0;
+		std::vector<Cost> costs;
+	};
+
+	using CostMap = BasicCostMap<>;
+
+	/*
+	* Terrain costs in square patches of patch_size cells: each patch gets one
+	* cost in [1, max_cost] drawn from rng, passed to setCost(x, y, cost) for
+	* every open cell of the sink (see the generators for sinks).
+	*/
+	template <class Rng, class Sink, class SetCost>
+	void generatePatchCosts(Rng& rng, const Sink& cells, int max_cost, SetCost&& setCost, int patch_size = 8) {
+		int patches_per_row = (cells.width() + patch_size - 1) / patch_size;
+		int patches_per_column = (cells.height() + patch_size - 1) / patch_size;
+		std::vector<int> patch_costs(patches_per_row * patches_per_column);
+		for (int& cost : patch_costs)
+			cost = 1 + uniformBelow(rng, max_cost);
+
+		for (int y = 0; y < cells.height(); y++) {
+			for (int x = 0; x < cells.width(); x++) {
+				if (cells.test(x, y))
+					setCost(x, y, patch_costs[(y / patch_size) * patches_per_row + x / patch_size]);
+			}
+		}
+	}
+};
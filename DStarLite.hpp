@@ -0,0 +1,220 @@
+#pragma once
+
+#include <vector>
+#include <climits>
+#include <cstdlib>
+#include <optional>
+#include <algorithm>
+
+#include "Search.hpp"
+#include "PriorityQueue.hpp"
+#include "AStar.hpp"
+#include "NodeOrder.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * D* Lite incremental planner between a start and a goal.
+	 *
+	 * The search runs backwards from the goal and keeps, for every node, g
+	 * (the distance to the goal found so far) and rhs (the one step lookahead
+	 * min over neighbours of step cost + g). Nodes where both differ are queued.
+	 * After a change only the nodes around it are updated, and the repair
+	 * spreads only as far as the change actually affects distances, so a
+	 * replan after a few toggled cells costs a small fraction of a full search.
+	 *
+	 * The planner reads the graph it was given, which must outlive it. After
+	 * changing the graph tell the planner through updateEdge() (edges changed
+	 * by connectNodes/disconnectNodes) or updateCell() (a grid cell toggled or
+	 * its cost changed). The start may move between plans; a new goal restarts
+	 * the planner.
+	 */
+	template <class Graph>
+	class DStarLite {
+	public:
+		DStarLite(const Graph& graph, int start, int goal)
+			:graph(graph), start(start), goal(goal) {
+			initialize();
+		}
+
+	public:
+		/*
+		* Repairs the distances and walks the path from start to goal, always
+		* stepping to the neighbour with the smallest step cost + g.
+		*/
+		std::optional<std::vector<int>> findPath() {
+			computeShortestPath();
+			if (g[start] == k_infinity)
+				return std::nullopt;
+
+			std::vector<int> path{ start };
+			for (int node = start; node != goal;) {
+				int best = -1;
+				int best_distance = k_infinity;
+				graph.forEachNeighbour(node, [&](int next_node) {
+					if (g[next_node] == k_infinity)
+						return;
+					int distance = stepCost(graph, next_node) + g[next_node];
+					if (distance < best_distance) {
+						best_distance = distance;
+						best = next_node;
+					}
+				});
+
+				// g is only trusted once consistent, a dead end here means it is not
+				if (best == -1 || path.size() > g.size())
+					return std::nullopt;
+				path.push_back(best);
+				node = best;
+			}
+			return path;
+		}
+
+		/*
+		* Moves the start, the queued keys stay valid through the km offset.
+		*/
+		void setStart(int node) {
+			km += heuristic(start, node);
+			start = node;
+		}
+
+		/*
+		* A new goal invalidates every distance, the planner starts over.
+		*/
+		void setGoal(int node) {
+			goal = node;
+			initialize();
+		}
+
+		int startNode() const {
+			return start;
+		}
+
+		int goalNode() const {
+			return goal;
+		}
+
+		/*
+		* The edge between u and v was added, removed or changed cost.
+		*/
+		void updateEdge(int u, int v) {
+			updateVertex(u);
+			updateVertex(v);
+		}
+
+		/*
+		* A grid cell was enabled, disabled or changed cost: the cell and its
+		* four grid neighbours may have new edges.
+		*/
+		void updateCell(int node) {
+			auto order = gridOrder(graph);
+			int x = order.x(node);
+			int y = order.y(node);
+
+			updateVertex(node);
+			if (x > 0)
+				updateVertex(order.index(x - 1, y));
+			if (x < graph.width() - 1)
+				updateVertex(order.index(x + 1, y));
+			if (y > 0)
+				updateVertex(order.index(x, y - 1));
+			if (y < graph.height() - 1)
+				updateVertex(order.index(x, y + 1));
+		}
+
+		/*
+		* Nodes expanded by the last findPath().
+		*/
+		int expandedNodes() const {
+			return expanded;
+		}
+
+	private:
+		static constexpr int k_infinity = INT_MAX;
+
+		void initialize() {
+			g.assign(graph.size(), k_infinity);
+			rhs.assign(graph.size(), k_infinity);
+			queued_nodes.resize(graph.size());
+			km = 0;
+
+			rhs[goal] = 0;
+			queued_nodes.push(calculateKey(goal), goal);
+		}
+
+		/*
+		* Manhattan distance decoded through the graph's order, 0 without grid.
+		*/
+		int heuristic(int a, int b) const {
+			if (graph.width() <= 0)
+				return 0;
+			return manhattanDistance(graph)(a, b);
+		}
+
+		/*
+		* [min(g, rhs) + h + km; min(g, rhs)], packed so it compares as one key.
+		*/
+		PriorityKey calculateKey(int node) const {
+			int distance = std::min(g[node], rhs[node]);
+			if (distance == k_infinity)
+				return packKey(k_infinity, k_infinity);
+			return packKey(distance + heuristic(start, node) + km, distance);
+		}
+
+		void updateVertex(int node) {
+			if (node != goal) {
+				int best = k_infinity;
+				graph.forEachNeighbour(node, [&](int next_node) {
+					if (g[next_node] != k_infinity)
+						best = std::min(best, stepCost(graph, next_node) + g[next_node]);
+				});
+				rhs[node] = best;
+			}
+
+			if (g[node] != rhs[node])
+				queued_nodes.update(calculateKey(node), node);
+			else if (queued_nodes.contains(node))
+				queued_nodes.remove(node);
+		}
+
+		void computeShortestPath() {
+			expanded = 0;
+			while (!queued_nodes.empty() && (queued_nodes.top().key < calculateKey(start) || rhs[start] != g[start])) {
+				auto [old_key, node] = queued_nodes.top();
+				PriorityKey new_key = calculateKey(node);
+				expanded++;
+
+				if (old_key < new_key) {
+					queued_nodes.update(new_key, node);
+				}
+				else if (g[node] > rhs[node]) {
+					// overconsistent: settle it and let the neighbours improve through it
+					g[node] = rhs[node];
+					queued_nodes.remove(node);
+					graph.forEachNeighbour(node, [&](int previous) {
+						updateVertex(previous);
+					});
+				}
+				else {
+					// underconsistent: forget the old distance and recompute around it
+					g[node] = k_infinity;
+					updateVertex(node);
+					graph.forEachNeighbour(node, [&](int previous) {
+						updateVertex(previous);
+					});
+				}
+			}
+		}
+
+	private:
+		const Graph& graph;
+		int start;
+		int goal;
+		int km = 0;
+		int expanded = 0;
+
+		std::vector<int> g;
+		std::vector<int> rhs;
+		QuaternaryHeap queued_nodes;
+	};
+};
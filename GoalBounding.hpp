@@ -0,0 +1,205 @@
+#pragma once
+
+#include <bit>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+#include "Search.hpp"
+#include "Parallel.hpp"
+#include "NodeOrder.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Goal bounding: per edge boxes around the targets it leads to.
+	 *
+	 * For every cell and each of its four edges the table keeps the bounding
+	 * box of all targets some shortest path reaches through that edge. A
+	 * search may skip an edge whose box does not contain the goal: no
+	 * shortest path to it starts there. Ties keep the target in the box of
+	 * every optimal edge, so the edges of canonical paths, which JPS relies
+	 * on, always survive.
+	 *
+	 * Boxes are computed with one search per cell, breadth first on uniform
+	 * costs and Dijkstra otherwise, in parallel. This is quadratic like a
+	 * path database but stores only 32 bytes per cell. The table is a
+	 * snapshot for static maps, grids up to 65535 cells wide and high.
+	 */
+	class GoalBounding {
+	public:
+		// same order as the grid graphs visit neighbours in
+		enum Direction { k_left, k_right, k_up, k_down };
+
+		GoalBounding() = default;
+
+		template <class Graph>
+		GoalBounding(const Graph& graph, int threads = 0) {
+			build(graph, threads);
+		}
+
+	public:
+		/*
+		* threads = 0 uses one thread per hardware thread.
+		*/
+		template <class Graph>
+		void build(const Graph& graph, int threads = 0) {
+			static_assert(RowMajorGrid<Graph>, "boxes decode node ids as row major cells");
+			// box corners are 16 bit coordinates
+			assert(graph.width() <= UINT16_MAX && graph.height() <= UINT16_MAX);
+			grid_width = graph.width();
+			boxes.assign(static_cast<size_t>(graph.size()) * 4, Box{});
+
+			// coordinates once, not a division per target and source
+			std::vector<std::uint16_t> xs(graph.size());
+			std::vector<std::uint16_t> ys(graph.size());
+			for (int node = 0; node < graph.size(); node++) {
+				xs[node] = static_cast<std::uint16_t>(node % grid_width);
+				ys[node] = static_cast<std::uint16_t>(node / grid_width);
+			}
+
+			std::vector<Scratch> scratch(workerCount(threads));
+			parallelFor(static_cast<int>(scratch.size()), graph.size(), [&](int thread, int source) {
+				Scratch& state = scratch[thread];
+				firstDirections(graph, source, state);
+
+				Box* own = &boxes[static_cast<size_t>(source) * 4];
+				for (int target : state.tree.order) {
+					for (unsigned bits = state.directions[target]; bits != 0; bits &= bits - 1)
+						own[std::countr_zero(bits)].add(xs[target], ys[target]);
+				}
+			});
+		}
+
+		/*
+		* Whether a shortest path from node to goal can start in direction.
+		*/
+		bool contains(int node, int direction, int goal) const {
+			return boxes[static_cast<size_t>(node) * 4 + direction].contains(goal % grid_width, goal / grid_width);
+		}
+
+		/*
+		* Whether a shortest path from node to goal can start with the step
+		* to the grid neighbour next_node.
+		*/
+		bool allows(int node, int next_node, int goal) const {
+			return contains(node, direction(node, next_node), goal);
+		}
+
+		size_t tableBytes() const {
+			return boxes.size() * sizeof(Box);
+		}
+
+	private:
+		/*
+		* Empty while min > max.
+		*/
+		struct Box {
+			std::uint16_t min_x = UINT16_MAX;
+			std::uint16_t min_y = UINT16_MAX;
+			std::uint16_t max_x = 0;
+			std::uint16_t max_y = 0;
+
+			void add(std::uint16_t x, std::uint16_t y) {
+				min_x = std::min(min_x, x);
+				min_y = std::min(min_y, y);
+				max_x = std::max(max_x, x);
+				max_y = std::max(max_y, y);
+			}
+
+			bool contains(int x, int y) const {
+				return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+			}
+		};
+
+		/*
+		* Per thread state of the searches filling the boxes.
+		*/
+		struct Scratch {
+			SingleSourceTree tree;
+			// bit per direction leaving the source on some shortest path
+			std::vector<std::uint8_t> directions;
+		};
+
+		int direction(int node, int next_node) const {
+			// checked first, on a single column node - 1 is the cell above
+			if (next_node == node - grid_width)
+				return k_up;
+			if (next_node == node + grid_width)
+				return k_down;
+			return next_node < node ? k_left : k_right;
+		}
+
+		/*
+		* Every node collects the directions of the nodes it is reached from
+		* at its shortest distance. Those are all settled before it.
+		*/
+		template <class Graph>
+		void firstDirections(const Graph& graph, int source, Scratch& state) const {
+			std::vector<std::uint8_t>& directions = state.directions;
+			directions.assign(graph.size(), 0);
+			singleSourceTree(graph, source, state.tree, [&](int node, int next_node, bool improved) {
+				std::uint8_t through = node == source ? static_cast<std::uint8_t>(1 << direction(source, next_node)) : directions[node];
+				if (improved)
+					directions[next_node] = through;
+				else
+					directions[next_node] |= through;
+			});
+		}
+
+	private:
+		int grid_width = 0;
+		// four per cell, indexed by Direction
+		std::vector<Box> boxes;
+	};
+
+	/**
+	 * A grid graph seen through goal bounding: neighbours no shortest path
+	 * to the goal starts with are left out, so any search run on it, such as
+	 * aStar(), expands only edges that can still lead to the goal optimally.
+	 */
+	template <class Graph>
+	class GoalBoundedGraph {
+		static_assert(RowMajorGrid<Graph>, "boxes decode node ids as row major cells");
+
+	public:
+		GoalBoundedGraph(const Graph& graph, const GoalBounding& bounds, int goal)
+			:graph(graph), bounds(bounds), goal(goal) {
+		}
+
+	public:
+		int size() const {
+			return graph.size();
+		}
+
+		int width() const {
+			return graph.width();
+		}
+
+		int height() const {
+			return graph.height();
+		}
+
+		bool uniformCost() const {
+			return graph.uniformCost();
+		}
+
+		int cost(int node) const requires requires(const Graph& g) { g.cost(node); } {
+			return graph.cost(node);
+		}
+
+		template <class Fn>
+		void forEachNeighbour(int node, Fn&& fn) const {
+			graph.forEachNeighbour(node, [&](int next_node) {
+				if (bounds.allows(node, next_node, goal))
+					fn(next_node);
+			});
+		}
+
+	private:
+		const Graph& graph;
+		const GoalBounding& bounds;
+		int goal;
+	};
+};
@@ -5,142 +5,455 @@
 #include <climits>
 #include <cassert>
 #include <set>
+#include <span>
+#include <optional>
+#include <tuple>
+#include <cstdint>
+#include <algorithm>
+
+#include "CostMap.hpp"
+#include "NodeOrder.hpp"
+#include "Parallel.hpp"
+#include "ShortestPath.hpp"
 
 namespace dijkstra {
 
+	/*
+	* Checks if x belongs to [low, high] (inclusive)
+	*/
+	inline bool inRange(int x, int low, int high) {
+		if (x >= low && x <= high)
+			return true;
+		return false;
+	}
+
+	/*
+	* Each node located at(x, y) is indexed into the adjacency storage with this formula,
+	* the row major order; graphs built over another NodeOrder map cells with order().
+	*/
+	inline int nodeIndex(int x, int y, int w) {
+		return x + y * w;
+	}
+
 	/**
-	 * A weighted graph, implemented using a adjacency list.
+	 * Adjacency storage with one heap allocated list per node.
 	 */
-	class WeightedGraph {
+	class NestedAdjacency {
 	public:
-		WeightedGraph(std::vector<std::vector<int>>&& adjList)
-			:adjacencyList(std::move(adjList)) {
+		NestedAdjacency() = default;
+
+		NestedAdjacency(std::vector<std::vector<int>>&& lists)
+			:lists(std::move(lists)) {
+		}
+
+		static NestedAdjacency grid(int grid_width, int grid_height) {
+			return grid(RowMajorOrder(grid_width, grid_height));
+		}
+
+		/*
+		* 4-connected grid with its cells numbered by order (see NodeOrder.hpp).
+		* Only cells whose occupancy entry, row major, is not 0 are connected;
+		* an empty occupancy opens every cell. Rows are built in parallel.
+		*/
+		template <class Order>
+		static NestedAdjacency grid(const Order& order, std::span<const std::uint8_t> occupancy = {}, int threads = 0) {
+			int grid_width = order.width();
+			int grid_height = order.height();
+
+			std::vector<std::vector<int>> adjacencyList(order.size());
+
+			const auto open = [&](int x, int y) {
+				return occupancy.empty() || occupancy[x + static_cast<size_t>(y) * grid_width] != 0;
+			};
+
+			parallelFor(workerCount(threads), grid_height, [&](int, int y) {
+				for (int x = 0; x < grid_width; x++) {
+					if (!open(x, y))
+						continue;
+					std::vector<int>& list = adjacencyList[order.index(x, y)];
+
+					// calculate and store valid neighbours of this node
+					const auto checkAndPushNeighbour = [&](int pos, int x, int y, int lo, int hi) {
+						if (inRange(pos, lo, hi) && open(x, y))
+							list.push_back(order.index(x, y));
+					};
+
+					checkAndPushNeighbour(x - 1, x - 1, y, 0, grid_width - 1);
+					checkAndPushNeighbour(x + 1, x + 1, y, 0, grid_width - 1);
+					checkAndPushNeighbour(y - 1, x, y - 1, 0, grid_height - 1);
+					checkAndPushNeighbour(y + 1, x, y + 1, 0, grid_height - 1);
+				}
+			});
+
+			return NestedAdjacency(std::move(adjacencyList));
 		}
 
 	public:
-		using NodeDistancePair = std::tuple<int, int>;
+		int size() const {
+			return static_cast<int>(lists.size());
+		}
+
+		std::span<const int> neighbours(int node) const {
+			return lists[node];
+		}
 
-		struct Compare {
-			bool operator()(const NodeDistancePair& a, const NodeDistancePair& b) {
-				return std::get<1>(a) > std::get<1>(b);
+		bool contains(int node, int neighbour) const {
+			return std::find(lists[node].begin(), lists[node].end(), neighbour) != lists[node].end();
+		}
+
+		void add(int node, int neighbour) {
+			lists[node].push_back(neighbour);
+		}
+
+		void remove(int node, int neighbour) {
+			std::vector<int>& list = lists[node];
+			for (int i = 0; i < list.size(); i++) {
+				if (list[i] == neighbour) {
+					list[i] = list.back();
+					list.pop_back();
+				}
 			}
-		};
+		}
+
+	private:
+		std::vector<std::vector<int>> lists;
+	};
 
+	/**
+	 * Compressed sparse row adjacency storage.
+	 *
+	 * Every node owns a fixed-capacity slot inside one flat array of neighbours,
+	 * delimited by offsets. Only the first degrees[node] entries of a slot are
+	 * active; disconnected neighbours are swapped past that point instead of
+	 * being erased, so they can be reconnected later without reallocating.
+	 *
+	 * As a consequence only edges present when the storage was built can be
+	 * reconnected, adding any other edge is ignored.
+	 */
+	class CompressedAdjacency {
 	public:
+		CompressedAdjacency() = default;
+
+		CompressedAdjacency(const std::vector<std::vector<int>>& lists) {
+			offsets.reserve(lists.size() + 1);
+			degrees.reserve(lists.size());
+
+			offsets.push_back(0);
+			for (const auto& list : lists) {
+				targets.insert(targets.end(), list.begin(), list.end());
+				offsets.push_back(static_cast<int>(targets.size()));
+				degrees.push_back(static_cast<int>(list.size()));
+			}
+		}
+
+		static CompressedAdjacency grid(int grid_width, int grid_height) {
+			return grid(RowMajorOrder(grid_width, grid_height));
+		}
 
 		/*
-		* Helper static methods.
+		* 4-connected grid with its cells numbered by order (see NodeOrder.hpp).
+		* Slots are laid out in node order, so the neighbours of nodes with
+		* close ids are close in memory whatever the order.
+		*
+		* Only cells whose occupancy entry, row major, is not 0 are connected;
+		* an empty occupancy opens every cell. Slots still hold every grid
+		* neighbour, the blocked ones past the active part, so that blocked
+		* cells can be reconnected later. Rows are filled in parallel.
 		*/
+		template <class Order>
+		static CompressedAdjacency grid(const Order& order, std::span<const std::uint8_t> occupancy = {}, int threads = 0) {
+			int grid_width = order.width();
+			int grid_height = order.height();
+			int graph_size = order.size();
+			int workers = workerCount(threads);
+
+			CompressedAdjacency adjacency{};
+			adjacency.offsets.resize(graph_size + 1);
+			adjacency.degrees.assign(graph_size, 0);
+
+			// first pass: slot sizes, so the neighbour array is allocated once;
+			// padding ids of the order keep empty slots
+			parallelFor(workers, grid_height, [&](int, int y) {
+				for (int x = 0; x < grid_width; x++) {
+					int degree = (x > 0) + (x < grid_width - 1) + (y > 0) + (y < grid_height - 1);
+					adjacency.degrees[order.index(x, y)] = degree;
+				}
+			});
+			int total = 0;
+			for (int node = 0; node < graph_size; node++) {
+				adjacency.offsets[node] = total;
+				total += adjacency.degrees[node];
+			}
+			adjacency.offsets[graph_size] = total;
+			adjacency.targets.resize(total);
+
+			// second pass, the neighbours themselves
+			adjacency.fillGrid(order, occupancy, workers);
+			return adjacency;
+		}
 
 		/*
-		* Checks if x belongs to [low, high] (inclusive)
+		* Reconnects a grid built by grid(order) in place from occupancy, as
+		* grid(order, occupancy) would build it but without allocating. False,
+		* leaving the storage untouched, when the slots are not those of that
+		* grid.
 		*/
+		template <class Order>
+		bool reconnectGrid(const Order& order, std::span<const std::uint8_t> occupancy, int threads = 0) {
+			int grid_width = order.width();
+			int grid_height = order.height();
+			if (size() != order.size() || grid_width == 0 || grid_height == 0)
+				return false;
+			// every cell's slot its grid degree, so the padding ones are empty
+			if (offsets.back() != 2 * (grid_width - 1) * grid_height + 2 * grid_width * (grid_height - 1))
+				return false;
+			for (int y = 0; y < grid_height; y++) {
+				for (int x = 0; x < grid_width; x++) {
+					int node = order.index(x, y);
+					if (offsets[node + 1] - offsets[node] != (x > 0) + (x < grid_width - 1) + (y > 0) + (y < grid_height - 1))
+						return false;
+				}
+			}
+			fillGrid(order, occupancy, workerCount(threads));
+			return true;
+		}
+
+	public:
+		int size() const {
+			return static_cast<int>(degrees.size());
+		}
+
+		std::span<const int> neighbours(int node) const {
+			return { targets.data() + offsets[node], static_cast<size_t>(degrees[node]) };
+		}
+
+		bool contains(int node, int neighbour) const {
+			auto active = neighbours(node);
+			return std::find(active.begin(), active.end(), neighbour) != active.end();
+		}
+
+		void add(int node, int neighbour) {
+			int* begin = targets.data() + offsets[node];
+			int* end = targets.data() + offsets[node + 1];
+			int* first_inactive = begin + degrees[node];
+
+			int* found = std::find(first_inactive, end, neighbour);
+			if (found == end)
+				return;
+
+			std::swap(*found, *first_inactive);
+			degrees[node]++;
+		}
+
+		void remove(int node, int neighbour) {
+			int* begin = targets.data() + offsets[node];
+			int* last_active = begin + degrees[node] - 1;
+
+			int* found = std::find(begin, last_active + 1, neighbour);
+			if (found == last_active + 1)
+				return;
+
+			std::swap(*found, *last_active);
+			degrees[node]--;
+		}
+
+	private:
+		/*
+		* Open neighbours in the same order as NestedAdjacency::grid, blocked
+		* ones from the end of the slot.
+		*/
+		template <class Order>
+		void fillGrid(const Order& order, std::span<const std::uint8_t> occupancy, int workers) {
+			int grid_width = order.width();
+			int grid_height = order.height();
+
+			const auto open = [&](int x, int y) {
+				return occupancy.empty() || occupancy[x + static_cast<size_t>(y) * grid_width] != 0;
+			};
+
+			parallelFor(workers, grid_height, [&](int, int y) {
+				for (int x = 0; x < grid_width; x++) {
+					int this_node = order.index(x, y);
+					int* active = targets.data() + offsets[this_node];
+					int* inactive = targets.data() + offsets[this_node + 1];
+					int* slot = active;
+					bool this_open = open(x, y);
+
+					const auto place = [&](int x, int y) {
+						if (this_open && open(x, y))
+							*active++ = order.index(x, y);
+						else
+							*--inactive = order.index(x, y);
+					};
+
+					if (x > 0)
+						place(x - 1, y);
+					if (x < grid_width - 1)
+						place(x + 1, y);
+					if (y > 0)
+						place(x, y - 1);
+					if (y < grid_height - 1)
+						place(x, y + 1);
+					degrees[this_node] = static_cast<int>(active - slot);
+				}
+			});
+		}
+
+	private:
+		std::vector<int> offsets;
+		std::vector<int> degrees;
+		std::vector<int> targets;
+	};
+
+	/**
+	 * A weighted graph, implemented using an adjacency storage policy
+	 * (see NestedAdjacency and CompressedAdjacency). Moving into a node costs
+	 * that node's entry in a per node cost array of Cost values.
+	 *
+	 * Grid graphs number their cells with a node order policy (see
+	 * NodeOrder.hpp), row major by default. Adjacency, costs and any search
+	 * workspace are indexed by these ids, so a Morton or tiled order keeps
+	 * cells that are close on the grid close in all of them.
+	 */
+	template <class Adjacency, class Cost = std::uint8_t, class Order = RowMajorOrder>
+	class BasicWeightedGraph {
+	public:
+		BasicWeightedGraph(Adjacency&& adjacency)
+			:adjacencyList(std::move(adjacency)), costs(adjacencyList.size()) {
+		}
+
+		/*
+		* Graph built over a grid_width x grid_height grid, which lets point to
+		* point queries use the Manhattan distance as heuristic. The adjacency
+		* must number the cells in Order, as createAdjacencyList does.
+		*/
+		BasicWeightedGraph(Adjacency&& adjacency, int grid_width, int grid_height)
+			:adjacencyList(std::move(adjacency)), costs(adjacencyList.size()), grid_order(grid_width, grid_height) {
+		}
+
+	public:
+		using NodeDistancePair = dijkstra::NodeDistancePair;
+		using Compare = CompareDistance;
+
+	public:
+
+		/*
+		* Helper static methods.
+		*/
+
 		static bool inRange(int x, int low, int high) {
-			if (x >= low && x <= high)
-				return true;
-			return false;
+			return dijkstra::inRange(x, low, high);
 		}
 
 		/*
-		* Each node located at(x, y) is indexed into the adjacencyList with this formula.
+		* Row major index, use order().index() on graphs with another Order.
 		*/
 		static int nodeIndex(int x, int y, int w) {
-			return x + y * w;
+			return dijkstra::nodeIndex(x, y, w);
 		}
 
-		static std::vector<std::vector<int>> createAdjacencyList(int grid_width, int grid_height) {
-			int graph_size = grid_width * grid_height;
+		static Adjacency createAdjacencyList(int grid_width, int grid_height) {
+			return Adjacency::grid(Order(grid_width, grid_height));
+		}
 
-			std::vector<std::vector<int>> adjacencyList(graph_size);
+	public:
+		int size() const {
+			return adjacencyList.size();
+		}
 
-			for (int x = 0; x < grid_width; x++) {
-				for (int y = 0; y < grid_height; y++) {
-					int this_node = nodeIndex(x, y, grid_width);
+		int width() const {
+			return grid_order.width();
+		}
 
-					// calculate and store valid neighbours of this node
-					const auto checkAndPushNeighbour =
-						[&adjacencyList, &this_node, &grid_width]
-						(int pos, int x, int y, int lo, int hi) {
-						if (inRange(pos, lo, hi))
-							adjacencyList[this_node].push_back(nodeIndex(x, y, grid_width));
-						};
+		int height() const {
+			return grid_order.height();
+		}
 
-					checkAndPushNeighbour(x - 1, x - 1, y, 0, grid_width - 1);
-					checkAndPushNeighbour(x + 1, x + 1, y, 0, grid_width - 1);
-					checkAndPushNeighbour(y - 1, x, y - 1, 0, grid_height - 1);
-					checkAndPushNeighbour(y + 1, x, y + 1, 0, grid_height - 1);
-				}
+		/*
+		* Replaces every edge at once by the grid of the cells whose entry in
+		* occupancy, width() x height() row major, is not 0. One parallel pass
+		* instead of a disconnectNodes per blocked neighbour; costs are kept.
+		*/
+		void rebuildFromOccupancy(std::span<const std::uint8_t> occupancy, int threads = 0) {
+			assert(occupancy.size() == static_cast<size_t>(width()) * height());
+			// storages that can refill their grid in place skip the allocation
+			if constexpr (requires { adjacencyList.reconnectGrid(grid_order, occupancy, threads); }) {
+				if (adjacencyList.reconnectGrid(grid_order, occupancy, threads))
+					return;
 			}
-
-			return adjacencyList;
+			adjacencyList = Adjacency::grid(grid_order, occupancy, threads);
 		}
 
-	public:
-		void disconnectNodes(int node, int neighbour) {
+		/*
+		* Maps grid cells to node ids and back.
+		*/
+		const Order& order() const {
+			return grid_order;
+		}
 
-			auto search_and_delete = [](std::vector<int>& list, int target) {
-					for (int i = 0; i < list.size(); i++) {
-						if (list[i] == target) {
-							list[i] = list.back();
-							list.pop_back();
-						}
-					}
-				};
+		std::span<const int> neighbours(int node) const {
+			return adjacencyList.neighbours(node);
+		}
 
-			search_and_delete(adjacencyList[node], neighbour);
-			search_and_delete(adjacencyList[neighbour], node);
+		void disconnectNodes(int node, int neighbour) {
+			adjacencyList.remove(node, neighbour);
+			adjacencyList.remove(neighbour, node);
 		}
 
 		void connectNodes(int node, int neighbour) {
 			// nodes are already connected
-
-
-			if (std::find(adjacencyList[node].begin(), adjacencyList[node].end(), neighbour) != adjacencyList[node].end())
+			if (adjacencyList.contains(node, neighbour))
 				return;
-			if(std::find(adjacencyList[neighbour].begin(), adjacencyList[neighbour].end(), node) != adjacencyList[neighbour].end())
+			if (adjacencyList.contains(neighbour, node))
 				return;
 
-			adjacencyList[neighbour].push_back(node);
-			adjacencyList[node].push_back(neighbour);
+			adjacencyList.add(neighbour, node);
+			adjacencyList.add(node, neighbour);
 		}
 
-		std::vector<int> shortestPath(int start, int end) {
-			std::vector<int> parents = dijkstra(start);
-			std::vector<int> path{};
-			for (int i = end; i != -1; i = parents[i]) {
-				path.push_back(i);
-			}
-			std::reverse(path.begin(), path.end());
-			return path;
+		template <class Fn>
+		void forEachNeighbour(int node, Fn&& fn) const {
+			for (int next_node : adjacencyList.neighbours(node))
+				fn(next_node);
+		}
+
+		/*
+		* Cost of moving into node, 1 unless set otherwise.
+		*/
+		int cost(int node) const {
+			return costs.cost(node);
 		}
 
-		std::vector<int> dijkstra(int start) {
-			std::priority_queue<NodeDistancePair, std::vector<NodeDistancePair>, Compare> queued_nodes{};
-			std::vector<int> distances(adjacencyList.size(), INT_MAX);
-			std::vector<int> parents(adjacencyList.size(), -1);
+		void setCost(int node, int cost) {
+			costs.setCost(node, cost);
+		}
 
-			queued_nodes.push(std::make_pair(start, 0));
-			distances[start] = 0;
+		void clearCosts() {
+			costs.clear();
+		}
 
-			while (!queued_nodes.empty()) {
-				auto [node, current_distance] = queued_nodes.top();
-				queued_nodes.pop();
+		bool uniformCost() const {
+			return costs.uniform();
+		}
 
-				for (int i = 0; i < adjacencyList[node].size(); i++) {
-					int next_node = adjacencyList[node][i];
-					int weight = 1; /* fixed size because we are working in a grid */
+		template <class Queue = BinaryHeap>
+		std::optional<std::vector<int>> shortestPath(int start, int end, SearchEngine engine = SearchEngine::Automatic, BasicSearchWorkspace<Queue>* workspace = nullptr) const {
+			return findPath(*this, start, end, engine, workspace);
+		}
 
-					if (distances[next_node] > (distances[node] + weight)) {
-						distances[next_node] = (distances[node] + weight);
-						parents[next_node] = node;
-						queued_nodes.push(std::make_pair(next_node, distances[next_node]));
-					}
-				}
-			}
-			return parents;
+		template <class Queue = BinaryHeap>
+		std::vector<int> dijkstra(int start, BasicSearchWorkspace<Queue>* workspace = nullptr) const {
+			return shortestPathTree(*this, start, workspace);
 		}
 
 	private:
-		std::vector<std::vector<int>> adjacencyList;
+		Adjacency adjacencyList;
+		BasicCostMap<Cost> costs;
+		Order grid_order;
 	};
-};
\ No newline at end of file
+
+	using WeightedGraph = BasicWeightedGraph<CompressedAdjacency>;
+	using NestedWeightedGraph = BasicWeightedGraph<NestedAdjacency>;
+	using MortonWeightedGraph = BasicWeightedGraph<CompressedAdjacency, std::uint8_t, MortonOrder>;
+	using TiledWeightedGraph = BasicWeightedGraph<CompressedAdjacency, std::uint8_t, TiledOrder<>>;
+};
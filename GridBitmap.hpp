@@ -0,0 +1,150 @@
+#pragma once
+
+#include <bit>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace dijkstra {
+
+	/**
+	 * One bit per grid cell, packed row by row into 64 bit words.
+	 *
+	 * Rows are padded to a whole number of words so that a row can be processed
+	 * word by word without straddling into the next one. Padding bits are always 0.
+	 */
+	class GridBitmap {
+	public:
+		using Word = std::uint64_t;
+		static constexpr int k_word_bits = 64;
+
+		GridBitmap() = default;
+
+		GridBitmap(int width, int height, bool value = false)
+			:grid_width(width), grid_height(height), row_words((width + k_word_bits - 1) / k_word_bits),
+			words(static_cast<size_t>(row_words) * height, 0) {
+			if (value)
+				fill(true);
+		}
+
+	public:
+		int width() const {
+			return grid_width;
+		}
+
+		int height() const {
+			return grid_height;
+		}
+
+		int rowWords() const {
+			return row_words;
+		}
+
+		bool test(int x, int y) const {
+			return (words[wordIndex(x, y)] >> (x % k_word_bits)) & 1;
+		}
+
+		void set(int x, int y) {
+			words[wordIndex(x, y)] |= bit(x);
+		}
+
+		void reset(int x, int y) {
+			words[wordIndex(x, y)] &= ~bit(x);
+		}
+
+		void flip(int x, int y) {
+			words[wordIndex(x, y)] ^= bit(x);
+		}
+
+		void fill(bool value) {
+			std::fill(words.begin(), words.end(), 0);
+			if (!value)
+				return;
+			for (int y = 0; y < grid_height; y++) {
+				Word* r = row(y);
+				for (int i = 0; i < row_words; i++)
+					r[i] = ~Word{ 0 };
+				r[row_words - 1] &= lastWordMask();
+			}
+		}
+
+		/*
+		* Number of set bits.
+		*/
+		size_t count() const {
+			size_t total = 0;
+			for (Word word : words)
+				total += std::popcount(word);
+			return total;
+		}
+
+		/*
+		* Calls fn(x, y) for every set bit, row by row, skipping empty words.
+		* Each word is read once before its bits are visited, so fn may
+		* change the bits it has been called for.
+		*/
+		template <class Fn>
+		void forEachSet(Fn&& fn) const {
+			forEachBit(false, fn);
+		}
+
+		/*
+		* Same as forEachSet for the bits that are 0, padding excluded.
+		*/
+		template <class Fn>
+		void forEachReset(Fn&& fn) const {
+			forEachBit(true, fn);
+		}
+
+		/*
+		* Mask of the valid (non padding) bits of the last word of a row.
+		*/
+		Word lastWordMask() const {
+			int used = grid_width % k_word_bits;
+			return used == 0 ? ~Word{ 0 } : (Word{ 1 } << used) - 1;
+		}
+
+		Word* row(int y) {
+			return words.data() + static_cast<size_t>(y) * row_words;
+		}
+
+		const Word* row(int y) const {
+			return words.data() + static_cast<size_t>(y) * row_words;
+		}
+
+		size_t memoryUsage() const {
+			return words.size() * sizeof(Word);
+		}
+
+	private:
+		size_t wordIndex(int x, int y) const {
+			assert(x >= 0 && x < grid_width && y >= 0 && y < grid_height);
+			return static_cast<size_t>(y) * row_words + x / k_word_bits;
+		}
+
+		static Word bit(int x) {
+			return Word{ 1 } << (x % k_word_bits);
+		}
+
+		template <class Fn>
+		void forEachBit(bool inverted, Fn& fn) const {
+			for (int y = 0; y < grid_height; y++) {
+				const Word* r = row(y);
+				for (int i = 0; i < row_words; i++) {
+					Word word = inverted ? ~r[i] : r[i];
+					if (i == row_words - 1)
+						word &= lastWordMask();
+					for (; word != 0; word &= word - 1)
+						fn(i * k_word_bits + std::countr_zero(word), y);
+				}
+			}
+		}
+
+	private:
+		int grid_width = 0;
+		int grid_height = 0;
+		int row_words = 0;
+		std::vector<Word> words;
+	};
+};
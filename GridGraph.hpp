@@ -0,0 +1,225 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <algorithm>
+
+#include "Graph.hpp"
+#include "GridBitmap.hpp"
+#include "CostMap.hpp"
+#include "ComponentIndex.hpp"
+#include "BitParallelBFS.hpp"
+#include "ShortestPath.hpp"
+#include "Parallel.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * A 4-connected grid graph that stores no adjacency at all.
+	 *
+	 * Only a passability bitmap is kept (one bit per cell). Neighbours of a
+	 * cell are the passable cells to its left, right, top and bottom and are
+	 * generated on the fly while searching, so disabling or enabling a cell is
+	 * a single bit flip. Terrain costs live in a CostMap, allocated only once
+	 * a cell costs more than 1.
+	 */
+	class ImplicitGridGraph {
+	public:
+		ImplicitGridGraph(int width, int height)
+			:passable(width, height, true), costs(width * height) {
+		}
+
+	public:
+		int size() const {
+			return passable.width() * passable.height();
+		}
+
+		int width() const {
+			return passable.width();
+		}
+
+		int height() const {
+			return passable.height();
+		}
+
+		/*
+		* Always row major: the bitmap rows are what jump point search and
+		* the bit parallel kernels scan.
+		*/
+		RowMajorOrder order() const {
+			return { width(), height() };
+		}
+
+		const GridBitmap& passability() const {
+			return passable;
+		}
+
+		bool isPassable(int node) const {
+			return passable.test(node % width(), node / width());
+		}
+
+		void disableCell(int node) {
+			if (!isPassable(node))
+				return;
+			passable.reset(node % width(), node / width());
+			if (components)
+				components->cellDisabled(passable, node);
+		}
+
+		void enableCell(int node) {
+			if (isPassable(node))
+				return;
+			passable.set(node % width(), node / width());
+			if (components)
+				components->cellEnabled(passable, node);
+		}
+
+		void toggleCell(int node) {
+			if (isPassable(node))
+				disableCell(node);
+			else
+				enableCell(node);
+		}
+
+		/*
+		* Sets every cell at once from occupancy, width() x height() row major,
+		* where 0 is blocked; an empty occupancy opens every cell. Rows are
+		* packed a word at a time in parallel and tracked components are
+		* rebuilt once. Costs are kept.
+		*/
+		void rebuildFromOccupancy(std::span<const std::uint8_t> occupancy, int threads = 0) {
+			assert(occupancy.empty() || occupancy.size() == static_cast<size_t>(width()) * height());
+			if (occupancy.empty()) {
+				passable.fill(true);
+			}
+			else {
+				int w = width();
+				parallelFor(workerCount(threads), height(), [&](int, int y) {
+					const std::uint8_t* cells = occupancy.data() + static_cast<size_t>(y) * w;
+					GridBitmap::Word* words = passable.row(y);
+					for (int i = 0; i < passable.rowWords(); i++) {
+						int first = i * GridBitmap::k_word_bits;
+						int end = std::min(GridBitmap::k_word_bits, w - first);
+						GridBitmap::Word word = 0;
+						for (int bit = 0; bit < end; bit++)
+							word |= static_cast<GridBitmap::Word>(cells[first + bit] != 0) << bit;
+						words[i] = word;
+					}
+				});
+			}
+			if (components)
+				components.emplace(passable);
+		}
+
+		/*
+		* Takes over a bitmap of the same size as the passable cells, such as
+		* one a generator wrote into, without copying it. Tracked components
+		* are rebuilt once. Costs are kept.
+		*/
+		void assignPassability(GridBitmap&& bitmap) {
+			assert(bitmap.width() == width() && bitmap.height() == height());
+			passable = std::move(bitmap);
+			if (components)
+				components.emplace(passable);
+		}
+
+		/*
+		* Keeps a ComponentIndex up to date with every cell change, so that
+		* shortestPath answers unreachable pairs without searching. Off by
+		* default; turn it off around bulk edits and back on to rebuild once.
+		*/
+		void trackComponents(bool enabled = true) {
+			if (enabled)
+				components.emplace(passable);
+			else
+				components.reset();
+		}
+
+		bool tracksComponents() const {
+			return components.has_value();
+		}
+
+		/*
+		* O(1) with tracked components, otherwise a flood from a.
+		*/
+		bool connected(int a, int b) const {
+			if (components)
+				return components->connected(a, b);
+			return isPassable(a) && isPassable(b) && reachable(a).test(b % width(), b / width());
+		}
+
+		/*
+		* Same neighbour order as WeightedGraph::createAdjacencyList: left, right, up, down.
+		* A disabled cell has no neighbours and is nobody's neighbour.
+		*/
+		template <class Fn>
+		void forEachNeighbour(int node, Fn&& fn) const {
+			int w = width();
+			int x = node % w;
+			int y = node / w;
+
+			if (!passable.test(x, y))
+				return;
+
+			if (x > 0 && passable.test(x - 1, y))
+				fn(node - 1);
+			if (x < w - 1 && passable.test(x + 1, y))
+				fn(node + 1);
+			if (y > 0 && passable.test(x, y - 1))
+				fn(node - w);
+			if (y < height() - 1 && passable.test(x, y + 1))
+				fn(node + w);
+		}
+
+		/*
+		* Cost of moving into node, 1 unless set otherwise.
+		*/
+		int cost(int node) const {
+			return costs.cost(node);
+		}
+
+		void setCost(int node, int cost) {
+			costs.setCost(node, cost);
+		}
+
+		void clearCosts() {
+			costs.clear();
+		}
+
+		bool uniformCost() const {
+			return costs.uniform();
+		}
+
+		template <class Queue = BinaryHeap>
+		std::optional<std::vector<int>> shortestPath(int start, int end, SearchEngine engine = SearchEngine::Automatic, BasicSearchWorkspace<Queue>* workspace = nullptr) const {
+			// every engine would flood the start's whole component before giving up
+			if (components && start != end && !components->connected(start, end))
+				return std::nullopt;
+			return findPath(*this, start, end, engine, workspace);
+		}
+
+		template <class Queue = BinaryHeap>
+		std::vector<int> dijkstra(int start, BasicSearchWorkspace<Queue>* workspace = nullptr) const {
+			return shortestPathTree(*this, start, workspace);
+		}
+
+		/*
+		* Cells in the same component as start, flooded a whole word of cells at
+		* a time (see BitParallelBFS::reach).
+		*/
+		GridBitmap reachable(int start) const {
+			BitParallelBFS kernel(passable);
+			kernel.reach(start % width(), start / width());
+			return kernel.reachable();
+		}
+
+	private:
+		GridBitmap passable;
+		CostMap costs;
+		std::optional<ComponentIndex> components;
+	};
+};
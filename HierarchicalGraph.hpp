@@ -0,0 +1,651 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <cstdlib>
+#include <optional>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+
+#include "Search.hpp"
+#include "AStar.hpp"
+#include "PriorityQueue.hpp"
+#include "SearchWorkspace.hpp"
+#include "NodeOrder.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Hierarchical path finding (HPA*) on a grid graph.
+	 *
+	 * The grid is cut into square clusters of cluster_size cells. Where two
+	 * neighbouring clusters touch through a run of open cells an entrance is
+	 * placed (one in the middle of short runs, one at each end of long ones);
+	 * its two cells become abstract nodes joined by a one step edge. Inside a
+	 * cluster every pair of abstract nodes is joined by the cost of the best
+	 * path that stays in the cluster, cached in a small matrix.
+	 *
+	 * Level l clusters are 2^(l - 1) level 1 clusters wide and only keep the
+	 * abstract nodes on their own borders; their matrices are searched on
+	 * level l - 1. A query inserts start and goal level by level, searches
+	 * the top level and refines each abstract edge only when the path is
+	 * built, by searching the level below inside that edge's cluster. Paths
+	 * are near optimal: the abstraction only crosses clusters at entrances.
+	 *
+	 * The hierarchy reads the graph it was given, which must outlive it.
+	 * After a cell is disabled, enabled or changes cost call updateCell():
+	 * only the level 1 cluster of the cell, the neighbours sharing an edited
+	 * border and the clusters above them are recomputed.
+	 */
+	template <class Graph>
+	class HierarchicalGraph {
+		static_assert(RowMajorGrid<Graph>, "clusters decode node ids as row major cells");
+
+	public:
+		HierarchicalGraph(const Graph& graph, int cluster_size = 16, int levels = 2)
+			:graph(graph), cluster_size(cluster_size), levels(levels) {
+			build();
+		}
+
+	public:
+		void build() {
+			nodes.clear();
+			east_borders.assign(clusterCount(1), {});
+			south_borders.assign(clusterCount(1), {});
+			for (int cluster = 0; cluster < clusterCount(1); cluster++) {
+				rebuildBorder(cluster, true);
+				rebuildBorder(cluster, false);
+			}
+
+			clusters.assign(levels, {});
+			for (int level = 1; level <= levels; level++) {
+				clusters[level - 1].resize(clusterCount(level));
+				for (int cluster = 0; cluster < clusterCount(level); cluster++)
+					computeCluster(level, cluster);
+			}
+		}
+
+		/*
+		* A cell was disabled, enabled or changed cost.
+		*/
+		void updateCell(int node) {
+			int across = clustersAcross(1);
+			int cluster = clusterOf(node, 1);
+			Bounds bounds = clusterBounds(1, cluster);
+			int x = node % graph.width();
+			int y = node / graph.width();
+
+			std::vector<int> dirty{ cluster };
+			if (x == bounds.x1 - 1 && bounds.x1 < graph.width()) {
+				rebuildBorder(cluster, true);
+				dirty.push_back(cluster + 1);
+			}
+			if (x == bounds.x0 && x > 0) {
+				rebuildBorder(cluster - 1, true);
+				dirty.push_back(cluster - 1);
+			}
+			if (y == bounds.y1 - 1 && bounds.y1 < graph.height()) {
+				rebuildBorder(cluster, false);
+				dirty.push_back(cluster + across);
+			}
+			if (y == bounds.y0 && y > 0) {
+				rebuildBorder(cluster - across, false);
+				dirty.push_back(cluster - across);
+			}
+
+			// bottom up, every level searches the one below
+			for (int level = 1; level <= levels; level++) {
+				std::vector<int> parents{};
+				for (int child : dirty) {
+					Bounds child_bounds = clusterBounds(1, child);
+					parents.push_back(clusterOf(child_bounds.x0 + child_bounds.y0 * graph.width(), level));
+				}
+				std::sort(parents.begin(), parents.end());
+				parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+				for (int parent : parents)
+					computeCluster(level, parent);
+			}
+		}
+
+		std::optional<std::vector<int>> findPath(int start, int goal) {
+			if (start == goal)
+				return std::vector<int>{ start };
+
+			insert(start, goal);
+			std::optional<std::vector<int>> path{};
+			if (searchAbstract(levels, start, goal, nullptr, [](int, int) { return true; })) {
+				// refining searches again, keep the top level route first
+				std::vector<int> waypoints = abstractPath(goal);
+				path = std::vector<int>{ start };
+				for (size_t i = 1; i < waypoints.size(); i++)
+					refine(waypoints[i - 1], waypoints[i], levels, *path);
+			}
+			query_start = query_goal = -1;
+			return path;
+		}
+
+		int abstractNodeCount() const {
+			return static_cast<int>(nodes.size());
+		}
+
+	private:
+		struct Bounds {
+			int x0, y0, x1, y1;
+
+			bool contains(int node, int w) const {
+				int x = node % w;
+				int y = node / w;
+				return x >= x0 && x < x1 && y >= y0 && y < y1;
+			}
+		};
+
+		struct Entrance {
+			int inside;
+			int outside;
+		};
+
+		struct Link {
+			int node;
+			int level;
+		};
+
+		struct AbstractNode {
+			// highest level whose cluster borders the node lies on
+			int level = 0;
+			std::vector<Link> partners;
+			// index in the matrix of its cluster at every level
+			std::vector<int> slots;
+		};
+
+		struct Cluster {
+			std::vector<int> nodes;
+			// costs[i * nodes.size() + j]: from nodes[i] to nodes[j] inside the cluster
+			std::vector<int> costs;
+		};
+
+		struct Label {
+			int distance;
+			int parent;
+		};
+
+		struct Edge {
+			int node;
+			int cost;
+		};
+
+		int clusterSize(int level) const {
+			return cluster_size << (level - 1);
+		}
+
+		int clustersAcross(int level) const {
+			return (graph.width() + clusterSize(level) - 1) / clusterSize(level);
+		}
+
+		int clusterCount(int level) const {
+			int size = clusterSize(level);
+			return clustersAcross(level) * ((graph.height() + size - 1) / size);
+		}
+
+		int clusterOf(int node, int level) const {
+			int size = clusterSize(level);
+			return (node % graph.width()) / size + (node / graph.width()) / size * clustersAcross(level);
+		}
+
+		Bounds clusterBounds(int level, int cluster) const {
+			int size = clusterSize(level);
+			int x0 = cluster % clustersAcross(level) * size;
+			int y0 = cluster / clustersAcross(level) * size;
+			return { x0, y0, std::min(x0 + size, graph.width()), std::min(y0 + size, graph.height()) };
+		}
+
+		bool linked(int node, int next) const {
+			bool found = false;
+			graph.forEachNeighbour(node, [&](int next_node) {
+				found |= next_node == next;
+			});
+			return found;
+		}
+
+		/*
+		* Entrances on the east (or south) edge of a level 1 cluster: one in the
+		* middle of every run of open crossings shorter than 6, one at each end
+		* of longer runs.
+		*/
+		void rebuildBorder(int cluster, bool east) {
+			std::vector<Entrance>& border = east ? east_borders[cluster] : south_borders[cluster];
+			std::vector<int> touched{};
+			for (const Entrance& entrance : border) {
+				touched.push_back(entrance.inside);
+				touched.push_back(entrance.outside);
+			}
+			border.clear();
+
+			Bounds bounds = clusterBounds(1, cluster);
+			int w = graph.width();
+			if ((east && bounds.x1 < w) || (!east && bounds.y1 < graph.height())) {
+				int length = east ? bounds.y1 - bounds.y0 : bounds.x1 - bounds.x0;
+				int first = east ? bounds.x1 - 1 + bounds.y0 * w : bounds.x0 + (bounds.y1 - 1) * w;
+				int along = east ? w : 1;
+				int across = east ? 1 : w;
+
+				auto open = [&](int i) {
+					int inside = first + i * along;
+					return linked(inside, inside + across);
+				};
+				auto place = [&](int i) {
+					int inside = first + i * along;
+					border.push_back({ inside, inside + across });
+				};
+
+				for (int i = 0; i < length;) {
+					if (!open(i)) {
+						i++;
+						continue;
+					}
+					int run = i;
+					while (i < length && open(i))
+						i++;
+					if (i - run < 6) {
+						place((run + i - 1) / 2);
+					}
+					else {
+						place(run);
+						place(i - 1);
+					}
+				}
+			}
+
+			for (const Entrance& entrance : border) {
+				touched.push_back(entrance.inside);
+				touched.push_back(entrance.outside);
+			}
+			for (int node : touched)
+				refreshNode(node);
+		}
+
+		/*
+		* Level of the border an entrance crosses: level l borders fall on
+		* multiples of the level l cluster size.
+		*/
+		int borderLevel(const Entrance& entrance) const {
+			int w = graph.width();
+			bool east = entrance.outside == entrance.inside + 1;
+			int line = east ? entrance.outside % w : entrance.outside / w;
+			int level = 1;
+			while (level < levels && line % clusterSize(level + 1) == 0)
+				level++;
+			return level;
+		}
+
+		/*
+		* Rebuilds the abstract node of a cell from the borders around it,
+		* dropping it when no entrance uses it anymore.
+		*/
+		void refreshNode(int node) {
+			int w = graph.width();
+			int cluster = clusterOf(node, 1);
+			Bounds bounds = clusterBounds(1, cluster);
+			int x = node % w;
+			int y = node / w;
+
+			AbstractNode refreshed{};
+			auto collect = [&](const std::vector<Entrance>& border) {
+				for (const Entrance& entrance : border) {
+					if (entrance.inside != node && entrance.outside != node)
+						continue;
+					int level = borderLevel(entrance);
+					refreshed.partners.push_back({ entrance.inside == node ? entrance.outside : entrance.inside, level });
+					refreshed.level = std::max(refreshed.level, level);
+				}
+			};
+			if (x == bounds.x1 - 1)
+				collect(east_borders[cluster]);
+			if (y == bounds.y1 - 1)
+				collect(south_borders[cluster]);
+			if (x == bounds.x0 && x > 0)
+				collect(east_borders[cluster - 1]);
+			if (y == bounds.y0 && y > 0)
+				collect(south_borders[cluster - clustersAcross(1)]);
+
+			if (refreshed.partners.empty()) {
+				nodes.erase(node);
+				return;
+			}
+			refreshed.slots.assign(levels, -1);
+			nodes[node] = std::move(refreshed);
+		}
+
+		/*
+		* Collects the abstract nodes on the rim of a cluster and fills its
+		* matrix with one search per node on the level below.
+		*/
+		void computeCluster(int level, int index) {
+			Cluster& cluster = clusters[level - 1][index];
+			Bounds bounds = clusterBounds(level, index);
+			int w = graph.width();
+
+			cluster.nodes.clear();
+			auto visit = [&](int x, int y) {
+				auto it = nodes.find(x + y * w);
+				if (it != nodes.end() && it->second.level >= level) {
+					it->second.slots[level - 1] = static_cast<int>(cluster.nodes.size());
+					cluster.nodes.push_back(x + y * w);
+				}
+			};
+			for (int x = bounds.x0; x < bounds.x1; x++) {
+				visit(x, bounds.y0);
+				if (bounds.y1 - 1 > bounds.y0)
+					visit(x, bounds.y1 - 1);
+			}
+			for (int y = bounds.y0 + 1; y < bounds.y1 - 1; y++) {
+				visit(bounds.x0, y);
+				if (bounds.x1 - 1 > bounds.x0)
+					visit(bounds.x1 - 1, y);
+			}
+
+			size_t n = cluster.nodes.size();
+			cluster.costs.assign(n * n, INT_MAX);
+			for (size_t i = 0; i < n; i++) {
+				size_t found = 0;
+				search(level - 1, cluster.nodes[i], -1, &bounds, [&](int node, int distance) {
+					const AbstractNode* abstract = rimNode(node, level, bounds);
+					if (abstract == nullptr)
+						return true;
+					cluster.costs[i * n + abstract->slots[level - 1]] = distance;
+					return ++found < n;
+				});
+			}
+		}
+
+		/*
+		* The abstract node of level >= level at node, only ever found on the
+		* rim of its cluster, which saves the lookup for every other cell.
+		*/
+		const AbstractNode* rimNode(int node, int level, const Bounds& bounds) const {
+			int x = node % graph.width();
+			int y = node / graph.width();
+			if (x != bounds.x0 && x != bounds.x1 - 1 && y != bounds.y0 && y != bounds.y1 - 1)
+				return nullptr;
+			auto it = nodes.find(node);
+			return it != nodes.end() && it->second.level >= level ? &it->second : nullptr;
+		}
+
+		/*
+		* Connects goal, then start, to the abstract nodes of their cluster at
+		* every level, each level searching the one below. Start also connects
+		* straight to goal when both share a cluster.
+		*/
+		void insert(int start, int goal) {
+			start_edges.assign(levels, {});
+			goal_edges_in.assign(levels, {});
+			goal_edges_out.assign(levels, {});
+			query_start = -1;
+			query_goal = goal;
+
+			for (int level = 1; level <= levels; level++) {
+				int cluster = clusterOf(goal, level);
+				Bounds bounds = clusterBounds(level, cluster);
+				size_t targets = clusters[level - 1][cluster].nodes.size();
+				size_t found = 0;
+				search(level - 1, goal, -1, &bounds, [&](int node, int distance) {
+					if (rimNode(node, level, bounds) == nullptr)
+						return true;
+					if (node != goal) {
+						goal_edges_out[level - 1].push_back({ node, distance });
+						// the same path walked backwards enters goal instead of node
+						goal_edges_in[level - 1].push_back({ node, distance - stepCost(graph, node) + stepCost(graph, goal) });
+					}
+					return ++found < targets;
+				});
+			}
+
+			query_start = start;
+			for (int level = 1; level <= levels; level++) {
+				int cluster = clusterOf(start, level);
+				Bounds bounds = clusterBounds(level, cluster);
+				size_t targets = clusters[level - 1][cluster].nodes.size() + bounds.contains(goal, graph.width());
+				size_t found = 0;
+				search(level - 1, start, -1, &bounds, [&](int node, int distance) {
+					if (node != goal && rimNode(node, level, bounds) == nullptr)
+						return true;
+					if (node != start)
+						start_edges[level - 1].push_back({ node, distance });
+					return ++found < targets;
+				});
+			}
+		}
+
+		/*
+		* Edges of node in the level graph, level >= 1.
+		*/
+		template <class Fn>
+		void forEachEdge(int node, int level, Fn&& fn) const {
+			if (node == query_start)
+				for (const Edge& edge : start_edges[level - 1])
+					fn(edge.node, edge.cost);
+			if (node == query_goal)
+				for (const Edge& edge : goal_edges_out[level - 1])
+					fn(edge.node, edge.cost);
+
+			auto it = nodes.find(node);
+			if (it != nodes.end() && it->second.level >= level) {
+				const Cluster& cluster = clusters[level - 1][clusterOf(node, level)];
+				size_t n = cluster.nodes.size();
+				size_t slot = it->second.slots[level - 1];
+				for (size_t j = 0; j < n; j++)
+					if (j != slot && cluster.costs[slot * n + j] != INT_MAX)
+						fn(cluster.nodes[j], cluster.costs[slot * n + j]);
+				for (const Link& partner : it->second.partners)
+					if (partner.level >= level)
+						fn(partner.node, stepCost(graph, partner.node));
+			}
+
+			if (query_goal != -1 && node != query_goal)
+				for (const Edge& edge : goal_edges_in[level - 1])
+					if (edge.node == node)
+						fn(query_goal, edge.cost);
+		}
+
+		/*
+		* A* (Dijkstra without target) on one level, inside bounds when given.
+		* settle(node, distance) sees nodes in order and returns false to stop.
+		* Returns true when target was settled.
+		*/
+		template <class Settle>
+		bool search(int level, int from, int target, const Bounds* bounds, Settle&& settle) {
+			if (level == 0)
+				return searchCells(from, target, *bounds, settle);
+			return searchAbstract(level, from, target, bounds, settle);
+		}
+
+		int estimate(int node, int target) const {
+			return target == -1 ? 0 : ManhattanDistance{ graph.width() }(node, target);
+		}
+
+		template <class Settle>
+		bool searchAbstract(int level, int from, int target, const Bounds* bounds, Settle&& settle) {
+			labels.clear();
+			heap.clear();
+			labels[from] = { 0, -1 };
+			heap.push(BinaryHeap::key(estimate(from, target), 0), from);
+
+			while (!heap.empty()) {
+				auto [key, node] = heap.pop();
+				int distance = labels[node].distance;
+				if (keyPrimary(key) > distance + estimate(node, target))
+					continue;
+				if (!settle(node, distance))
+					return false;
+				if (node == target)
+					return true;
+
+				forEachEdge(node, level, [&](int next_node, int cost) {
+					if (bounds != nullptr && !bounds->contains(next_node, graph.width()))
+						return;
+					auto [it, inserted] = labels.try_emplace(next_node, Label{ INT_MAX, -1 });
+					if (distance + cost < it->second.distance) {
+						it->second = { distance + cost, node };
+						int h = estimate(next_node, target);
+						heap.push(BinaryHeap::key(distance + cost + h, h), next_node);
+					}
+				});
+			}
+			return false;
+		}
+
+		/*
+		* The grid inside one level 1 cluster, with per cluster arrays.
+		*/
+		template <class Settle>
+		bool searchCells(int from, int target, const Bounds& bounds, Settle&& settle) {
+			int w = graph.width();
+			int span = bounds.x1 - bounds.x0;
+			int area = span * (bounds.y1 - bounds.y0);
+			if (static_cast<int>(cell_stamps.size()) < area) {
+				cell_stamps.assign(area, 0);
+				cell_labels.resize(area);
+			}
+			if (++cell_generation == 0) {
+				std::fill(cell_stamps.begin(), cell_stamps.end(), 0);
+				cell_generation = 1;
+			}
+			cell_bounds = bounds;
+
+			// all in cluster coordinates, so the inner loop needs no division
+			int rows = bounds.y1 - bounds.y0;
+			int tx = target == -1 ? 0 : target % w - bounds.x0;
+			int ty = target == -1 ? 0 : target / w - bounds.y0;
+			auto estimateAt = [&](int x, int y) {
+				return target == -1 ? 0 : std::abs(x - tx) + std::abs(y - ty);
+			};
+
+			// with unit costs a FIFO settles cells in distance order already
+			bool uniform = graph.uniformCost();
+			int from_x = from % w - bounds.x0;
+			int from_y = from / w - bounds.y0;
+			heap.clear();
+			fifo.clear();
+			cell_stamps[from_x + from_y * span] = cell_generation;
+			cell_labels[from_x + from_y * span] = { 0, -1 };
+			if (uniform)
+				fifo.push(from);
+			else
+				heap.push(BinaryHeap::key(estimateAt(from_x, from_y), 0), from);
+
+			while (uniform ? !fifo.empty() : !heap.empty()) {
+				QueueEntry top{ 0, -1 };
+				if (uniform)
+					top.node = fifo.pop();
+				else
+					top = heap.pop();
+				auto [key, node] = top;
+				int x = node % w - bounds.x0;
+				int y = node / w - bounds.y0;
+				int i = x + y * span;
+				int distance = cell_labels[i].distance;
+				if (!uniform && keyPrimary(key) > distance + estimateAt(x, y))
+					continue;
+				if (!settle(node, distance))
+					return false;
+				if (node == target)
+					return true;
+
+				graph.forEachNeighbour(node, [&](int next_node) {
+					// from its own coordinates, on a single column node - 1 is the cell above
+					int next_x = next_node % w - bounds.x0;
+					int next_y = next_node / w - bounds.y0;
+					if (next_x < 0 || next_x >= span || next_y < 0 || next_y >= rows)
+						return;
+
+					int j = next_x + next_y * span;
+					int next_distance = distance + stepCost(graph, next_node);
+					if (cell_stamps[j] != cell_generation || next_distance < cell_labels[j].distance) {
+						cell_stamps[j] = cell_generation;
+						cell_labels[j] = { next_distance, node };
+						int h = estimateAt(next_x, next_y);
+						if (uniform)
+							fifo.push(next_node);
+						else
+							heap.push(BinaryHeap::key(next_distance + h, h), next_node);
+					}
+				});
+			}
+			return false;
+		}
+
+		/*
+		* Nodes from the last search's source to target, both included.
+		*/
+		std::vector<int> abstractPath(int target) const {
+			std::vector<int> path{};
+			for (int node = target; node != -1; node = labels.at(node).parent)
+				path.push_back(node);
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		std::vector<int> cellPath(int target) const {
+			int w = graph.width();
+			int span = cell_bounds.x1 - cell_bounds.x0;
+			std::vector<int> path{};
+			for (int node = target; node != -1;)
+				path.push_back(std::exchange(node, cell_labels[(node % w - cell_bounds.x0) + (node / w - cell_bounds.y0) * span].parent));
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		/*
+		* Appends the cells after u up to v for an edge of the level graph.
+		*/
+		void refine(int u, int v, int level, std::vector<int>& path) {
+			auto it = nodes.find(u);
+			if (it != nodes.end()) {
+				for (const Link& partner : it->second.partners) {
+					if (partner.node == v && partner.level >= level) {
+						path.push_back(v);
+						return;
+					}
+				}
+			}
+
+			Bounds bounds = clusterBounds(level, clusterOf(u, level));
+			search(level - 1, u, v, &bounds, [](int, int) { return true; });
+			std::vector<int> waypoints = level == 1 ? cellPath(v) : abstractPath(v);
+			if (level == 1) {
+				path.insert(path.end(), waypoints.begin() + 1, waypoints.end());
+				return;
+			}
+			for (size_t i = 1; i < waypoints.size(); i++)
+				refine(waypoints[i - 1], waypoints[i], level - 1, path);
+		}
+
+	private:
+		const Graph& graph;
+		int cluster_size;
+		int levels;
+
+		std::unordered_map<int, AbstractNode> nodes;
+		// entrances on the east and south edge of every level 1 cluster
+		std::vector<std::vector<Entrance>> east_borders;
+		std::vector<std::vector<Entrance>> south_borders;
+		// clusters[level - 1][cluster]
+		std::vector<std::vector<Cluster>> clusters;
+
+		// start and goal of the running query and their edges at every level
+		int query_start = -1;
+		int query_goal = -1;
+		std::vector<std::vector<Edge>> start_edges;
+		std::vector<std::vector<Edge>> goal_edges_in;
+		std::vector<std::vector<Edge>> goal_edges_out;
+
+		BinaryHeap heap;
+		RingQueue fifo;
+		std::unordered_map<int, Label> labels;
+		std::vector<std::uint32_t> cell_stamps;
+		std::vector<Label> cell_labels;
+		std::uint32_t cell_generation = 0;
+		Bounds cell_bounds{};
+	};
+};
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <vector>
+#include <bit>
+#include <climits>
+#include <cstdlib>
+#include <optional>
+#include <algorithm>
+
+#include "GridBitmap.hpp"
+#include "AStar.hpp"
+#include "GoalBounding.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Jump Point Search for 4-connected uniform cost grids.
+	 *
+	 * Canonical paths move vertically first and may turn horizontal anywhere;
+	 * a horizontal move may only turn vertical at a forced neighbour, a cell
+	 * above or below that could not be reached by turning earlier because the
+	 * cell behind it is blocked. Searching only the cells where a canonical
+	 * path can turn (jump points) skips the long open stretches in between.
+	 *
+	 * Horizontal jumps are bit scans over the packed passability rows: forced
+	 * neighbours, blocked cells and the target are masks, and the first set bit
+	 * (countr_zero / countl_zero) decides where the jump ends.
+	 *
+	 * With precompute enabled (JPS+) the distance to the next jump point or
+	 * wall is stored per cell and direction, and jumps become table lookups.
+	 * The tables must be refreshed with refreshCell() after a cell changes.
+	 *
+	 * With a GoalBounding table set, jumps in directions whose box does not
+	 * contain the goal are not taken at all.
+	 *
+	 * The search reads the bitmap it was given directly, which must outlive it.
+	 */
+	class JumpPointSearch {
+	public:
+		using Word = GridBitmap::Word;
+
+		JumpPointSearch(const GridBitmap& passable, bool precompute = false)
+			:bitmap(passable), precomputed(precompute) {
+			if (precomputed)
+				buildTables();
+		}
+
+	public:
+		/*
+		* Without a workspace the search keeps its own between queries.
+		*/
+		template <class Queue = BinaryHeap>
+		std::optional<std::vector<int>> findPath(int start, int end, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+			if (workspace == nullptr)
+				return findPath(start, end, &own_workspace);
+
+			int w = bitmap.width();
+			expanded = 0;
+
+			if (start == end)
+				return std::vector<int>{ start };
+			if (!bitmap.test(start % w, start / w) || !bitmap.test(end % w, end / w))
+				return std::nullopt;
+
+			goal_x = end % w;
+			goal_y = end / w;
+
+			BasicSearchWorkspace<Queue>& search = *workspace;
+			search.reset(size());
+
+			// arrival direction of every jump point is kept in the node tag
+			ManhattanDistance heuristic{ w };
+			search.update(start, 0, -1);
+			search.setTag(start, k_none);
+			search.push(search.key(heuristic(start, end), heuristic(start, end)), start);
+
+			while (!search.heapEmpty()) {
+				auto [key, node] = search.pop();
+
+				if (node == end)
+					return unpack(search, start, end);
+
+				int current_distance = search.distance(node);
+				if (keyPrimary(key) > current_distance + heuristic(node, end))
+					continue;
+				expanded++;
+
+				forEachSuccessor(node, search.tag(node), [&](int next_node, int direction) {
+					int d = current_distance + heuristic(node, next_node);
+					if (d >= search.distance(next_node))
+						return;
+
+					search.update(next_node, d, node);
+					search.setTag(next_node, direction);
+
+					int h = heuristic(next_node, end);
+					search.push(search.key(d + h, h), next_node);
+				});
+			}
+			return std::nullopt;
+		}
+
+		/*
+		* Prunes jumps with bounds from now on, nullptr turns pruning off. The
+		* table must have been built for the same map.
+		*/
+		void setGoalBounding(const GoalBounding* bounds) {
+			goal_bounding = bounds;
+		}
+
+		/*
+		* Jump points expanded by the last query.
+		*/
+		int expandedNodes() const {
+			return expanded;
+		}
+
+		/*
+		* Updates the JPS+ tables after the cell changed in the bitmap. Only the
+		* three rows around the cell and the columns whose vertical jump points
+		* changed are recomputed.
+		*/
+		void refreshCell(int node) {
+			if (!precomputed)
+				return;
+
+			int w = bitmap.width();
+			int h = bitmap.height();
+			int x = node % w;
+			int y = node / w;
+
+			std::vector<int> touched_columns{ x };
+			for (int r = std::max(y - 1, 0); r <= std::min(y + 1, h - 1); r++) {
+				std::vector<char> before(w);
+				for (int c = 0; c < w; c++)
+					before[c] = isVerticalJumpPoint(c, r);
+
+				computeRow(r);
+
+				for (int c = 0; c < w; c++)
+					if (before[c] != isVerticalJumpPoint(c, r))
+						touched_columns.push_back(c);
+			}
+
+			std::sort(touched_columns.begin(), touched_columns.end());
+			touched_columns.erase(std::unique(touched_columns.begin(), touched_columns.end()), touched_columns.end());
+			for (int c : touched_columns)
+				computeColumn(c);
+		}
+
+	private:
+		enum Direction : char {
+			k_none,
+			k_right,
+			k_left,
+			k_down,
+			k_up,
+		};
+
+		int size() const {
+			return bitmap.width() * bitmap.height();
+		}
+
+		int cellIndex(int x, int y, int w) const {
+			return x + y * w;
+		}
+
+		bool passable(int x, int y) const {
+			return x >= 0 && x < bitmap.width() && y >= 0 && y < bitmap.height() && bitmap.test(x, y);
+		}
+
+		template <class Fn>
+		void forEachSuccessor(int node, int arrival, Fn&& fn) {
+			int w = bitmap.width();
+			int x = node % w;
+			int y = node / w;
+
+			int goal = cellIndex(goal_x, goal_y, w);
+			auto horizontal = [&](int dx) {
+				if (goal_bounding != nullptr && !goal_bounding->contains(node, dx > 0 ? GoalBounding::k_right : GoalBounding::k_left, goal))
+					return;
+				int jx = jumpHorizontal(x, y, dx);
+				if (jx != -1)
+					fn(cellIndex(jx, y, w), dx > 0 ? k_right : k_left);
+			};
+			auto vertical = [&](int dy) {
+				if (goal_bounding != nullptr && !goal_bounding->contains(node, dy > 0 ? GoalBounding::k_down : GoalBounding::k_up, goal))
+					return;
+				int jy = jumpVertical(x, y, dy);
+				if (jy != -1)
+					fn(cellIndex(x, jy, w), dy > 0 ? k_down : k_up);
+			};
+
+			if (arrival == k_none || arrival == k_down || arrival == k_up) {
+				horizontal(1);
+				horizontal(-1);
+				if (arrival != k_up)
+					vertical(1);
+				if (arrival != k_down)
+					vertical(-1);
+				return;
+			}
+
+			// arrived horizontally: keep going, turn only towards forced neighbours
+			int dx = arrival == k_right ? 1 : -1;
+			horizontal(dx);
+			for (int dy : { -1, 1 }) {
+				if (passable(x, y + dy) && !passable(x - dx, y + dy))
+					vertical(dy);
+			}
+		}
+
+		/*
+		* x of the first jump point moving from (x, y) along the row, or -1.
+		*/
+		int jumpHorizontal(int x, int y, int dx) const {
+			if (precomputed) {
+				int d = table(dx > 0 ? k_right : k_left)[cellIndex(x, y, bitmap.width())];
+				int steps = std::abs(d);
+				if (y == goal_y && (goal_x - x) * dx > 0 && std::abs(goal_x - x) <= steps)
+					return goal_x;
+				return d > 0 ? x + d * dx : -1;
+			}
+			return dx > 0 ? scanRight(x, y) : scanLeft(x, y);
+		}
+
+		/*
+		* y of the first jump point moving from (x, y) along the column, or -1.
+		* A cell is a jump point when a horizontal jump from it finds one.
+		*/
+		int jumpVertical(int x, int y, int dy) const {
+			if (precomputed) {
+				int d = table(dy > 0 ? k_down : k_up)[cellIndex(x, y, bitmap.width())];
+				int steps = std::abs(d);
+				// stop on the target row, the horizontal jumps from there find the target
+				if ((goal_y - y) * dy > 0 && std::abs(goal_y - y) <= steps)
+					return goal_y;
+				return d > 0 ? y + d * dy : -1;
+			}
+
+			for (int cy = y + dy; passable(x, cy); cy += dy) {
+				if (x == goal_x && cy == goal_y)
+					return cy;
+				if (scanRight(x, cy) != -1 || scanLeft(x, cy) != -1)
+					return cy;
+			}
+			return -1;
+		}
+
+		/*
+		* Cells of a row with a forced neighbour when entered moving right:
+		* the cell above (or below) is open but the one behind it is not.
+		*/
+		static Word forcedRight(const Word* side, int k) {
+			if (!side)
+				return 0;
+			Word previous = k > 0 ? side[k - 1] : 0;
+			return side[k] & ~((side[k] << 1) | (previous >> 63));
+		}
+
+		static Word forcedLeft(const Word* side, int k, int row_words) {
+			if (!side)
+				return 0;
+			Word following = k + 1 < row_words ? side[k + 1] : 0;
+			return side[k] & ~((side[k] >> 1) | (following << 63));
+		}
+
+		Word goalMask(int y, int k) const {
+			if (y != goal_y || goal_x / 64 != k)
+				return 0;
+			return Word{ 1 } << (goal_x % 64);
+		}
+
+		int scanRight(int x, int y) const {
+			int row_words = bitmap.rowWords();
+			const Word* row = bitmap.row(y);
+			const Word* up = y > 0 ? bitmap.row(y - 1) : nullptr;
+			const Word* down = y < bitmap.height() - 1 ? bitmap.row(y + 1) : nullptr;
+
+			int from = x + 1;
+			for (int k = from / 64; k < row_words; k++) {
+				Word stops = ((forcedRight(up, k) | forcedRight(down, k) | goalMask(y, k)) & row[k]) | ~row[k];
+				if (k == from / 64)
+					stops &= ~Word{ 0 } << (from % 64);
+				if (!stops)
+					continue;
+
+				int bit = std::countr_zero(stops);
+				return (row[k] >> bit) & 1 ? k * 64 + bit : -1;
+			}
+			return -1;
+		}
+
+		int scanLeft(int x, int y) const {
+			int row_words = bitmap.rowWords();
+			const Word* row = bitmap.row(y);
+			const Word* up = y > 0 ? bitmap.row(y - 1) : nullptr;
+			const Word* down = y < bitmap.height() - 1 ? bitmap.row(y + 1) : nullptr;
+
+			int from = x - 1;
+			if (from < 0)
+				return -1;
+			for (int k = from / 64; k >= 0; k--) {
+				Word stops = ((forcedLeft(up, k, row_words) | forcedLeft(down, k, row_words) | goalMask(y, k)) & row[k]) | ~row[k];
+				if (k == from / 64)
+					stops &= ~Word{ 0 } >> (63 - from % 64);
+				if (!stops)
+					continue;
+
+				int bit = 63 - std::countl_zero(stops);
+				return (row[k] >> bit) & 1 ? k * 64 + bit : -1;
+			}
+			return -1;
+		}
+
+		/*
+		* Expands the jump points into every cell of the path.
+		*/
+		template <class Workspace>
+		std::vector<int> unpack(const Workspace& search, int start, int end) const {
+			int w = bitmap.width();
+			std::vector<int> path{ end };
+			for (int node = end; node != start; node = search.parent(node)) {
+				int parent = search.parent(node);
+				int step = (parent % w == node % w) ? w : 1;
+				if (parent > node)
+					step = -step;
+				for (int cell = node - step; cell != parent; cell -= step)
+					path.push_back(cell);
+				path.push_back(parent);
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		/*
+		* JPS+ tables: for every cell and direction, d > 0 means the next jump
+		* point is d cells away, d <= 0 means a wall after -d open cells.
+		*/
+		std::vector<int>& table(int direction) {
+			return jump_tables[direction - 1];
+		}
+
+		const std::vector<int>& table(int direction) const {
+			return jump_tables[direction - 1];
+		}
+
+		bool forcedEntering(int x, int y, int dx) const {
+			for (int dy : { -1, 1 })
+				if (passable(x, y + dy) && !passable(x - dx, y + dy) && passable(x - dx, y))
+					return true;
+			return false;
+		}
+
+		bool isVerticalJumpPoint(int x, int y) const {
+			int node = cellIndex(x, y, bitmap.width());
+			return passable(x, y) && (table(k_right)[node] > 0 || table(k_left)[node] > 0);
+		}
+
+		void buildTables() {
+			for (auto& t : jump_tables)
+				t.assign(size(), 0);
+			for (int y = 0; y < bitmap.height(); y++)
+				computeRow(y);
+			for (int x = 0; x < bitmap.width(); x++)
+				computeColumn(x);
+		}
+
+		void computeRow(int y) {
+			int w = bitmap.width();
+			for (int dx : { 1, -1 }) {
+				std::vector<int>& t = table(dx > 0 ? k_right : k_left);
+				int first = dx > 0 ? w - 1 : 0;
+				for (int x = first; x >= 0 && x < w; x -= dx) {
+					int next_x = x + dx;
+					int d = 0;
+					if (passable(next_x, y)) {
+						if (forcedEntering(next_x, y, dx))
+							d = 1;
+						else {
+							int n = t[cellIndex(next_x, y, w)];
+							d = n > 0 ? n + 1 : n - 1;
+						}
+					}
+					t[cellIndex(x, y, w)] = d;
+				}
+			}
+		}
+
+		void computeColumn(int x) {
+			int w = bitmap.width();
+			int h = bitmap.height();
+			for (int dy : { 1, -1 }) {
+				std::vector<int>& t = table(dy > 0 ? k_down : k_up);
+				int first = dy > 0 ? h - 1 : 0;
+				for (int y = first; y >= 0 && y < h; y -= dy) {
+					int next_y = y + dy;
+					int d = 0;
+					if (passable(x, next_y)) {
+						if (isVerticalJumpPoint(x, next_y))
+							d = 1;
+						else {
+							int n = t[cellIndex(x, next_y, w)];
+							d = n > 0 ? n + 1 : n - 1;
+						}
+					}
+					t[cellIndex(x, y, w)] = d;
+				}
+			}
+		}
+
+	private:
+		const GridBitmap& bitmap;
+		bool precomputed;
+
+		int goal_x = -1;
+		int goal_y = -1;
+		int expanded = 0;
+		const GoalBounding* goal_bounding = nullptr;
+
+		SearchWorkspace own_workspace;
+
+		std::vector<int> jump_tables[4];
+	};
+};
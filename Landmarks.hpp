@@ -0,0 +1,317 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <random>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+
+#include "Search.hpp"
+
+namespace dijkstra {
+
+	enum class LandmarkSelection {
+		// each landmark as far as possible from the ones before
+		FarthestPoint,
+		// Goldberg and Werneck: grow a shortest path tree from a random root
+		// and descend into the subtree the current landmarks cover worst
+		Avoid,
+	};
+
+	class Landmarks;
+
+	/*
+	* A* heuristic reading the tables of a Landmarks object, cheap to copy.
+	*/
+	struct LandmarkDistance {
+		const Landmarks* landmarks;
+
+		int operator()(int node, int target) const;
+	};
+
+	/**
+	 * ALT: A* with landmarks and the triangle inequality.
+	 *
+	 * Distances from a few landmarks to every node are precomputed. For a
+	 * landmark L, d(L, target) <= d(L, node) + d(node, target), so
+	 * d(L, target) - d(L, node) is a lower bound of the remaining distance;
+	 * on uniform costs distances are symmetric and the bound works in both
+	 * directions. The best bound over all landmarks follows walls that
+	 * Manhattan distance ignores, which in mazes is most of the path.
+	 *
+	 * Tables are node major, the landmarks of one node share a cache line,
+	 * and use 16 bit entries whenever no distance can exceed them. They are
+	 * a snapshot: after edits call refresh(), which recomputes them for the
+	 * same landmarks with one thread per landmark, or select() to also pick
+	 * new landmarks. Until then opened cells can make the bound overestimate.
+	 */
+	class Landmarks {
+	public:
+		Landmarks() = default;
+
+		template <class Graph>
+		Landmarks(const Graph& graph, int count, LandmarkSelection selection = LandmarkSelection::Avoid) {
+			select(graph, count, selection);
+		}
+
+	public:
+		/*
+		* Picks count landmarks among the nodes with neighbours and fills
+		* their tables from the searches the selection ran.
+		*/
+		template <class Graph>
+		void select(const Graph& graph, int count, LandmarkSelection selection = LandmarkSelection::Avoid) {
+			landmarks.clear();
+			std::vector<std::vector<int>> distances{};
+			std::mt19937 rng(k_seed);
+
+			// a root in a small component may find nothing new, try another one
+			for (int attempt = 0; static_cast<int>(landmarks.size()) < count && attempt < 4 * count; attempt++) {
+				int root = randomRoot(graph, rng);
+				if (root == -1)
+					break;
+
+				int landmark = selection == LandmarkSelection::Avoid
+					? avoidLandmark(graph, root, distances)
+					: farthestLandmark(graph, root, distances);
+				if (landmark == -1 || std::find(landmarks.begin(), landmarks.end(), landmark) != landmarks.end())
+					continue;
+				landmarks.push_back(landmark);
+				distances.emplace_back();
+				distancesFrom(graph, landmark, distances.back());
+			}
+
+			// selection already searched from every landmark, keep those
+			fillTables(graph, distances);
+		}
+
+		/*
+		* Recomputes the tables for the current landmarks after the graph was
+		* edited, one thread per landmark. Threads only search, the node major
+		* rows they would all share are written once they are done.
+		*/
+		template <class Graph>
+		void refresh(const Graph& graph) {
+			std::vector<std::vector<int>> distances(landmarks.size());
+			std::vector<std::thread> workers{};
+			for (size_t k = 0; k < landmarks.size(); k++) {
+				workers.emplace_back([&, k] {
+					distancesFrom(graph, landmarks[k], distances[k]);
+				});
+			}
+			for (std::thread& worker : workers)
+				worker.join();
+			fillTables(graph, distances);
+		}
+
+		const std::vector<int>& nodes() const {
+			return landmarks;
+		}
+
+		/*
+		* Lower bound of the distance from node to target.
+		*/
+		int lowerBound(int node, int target) const {
+			return narrow.empty() ? lowerBound(wide, node, target, k_wide_unreachable) : lowerBound(narrow, node, target, k_narrow_unreachable);
+		}
+
+		LandmarkDistance heuristic() const {
+			return { this };
+		}
+
+		/*
+		* Bytes held by the distance tables.
+		*/
+		size_t tableBytes() const {
+			return narrow.size() * sizeof(std::uint16_t) + wide.size() * sizeof(std::uint32_t);
+		}
+
+	private:
+		static constexpr unsigned k_seed = 29;
+		static constexpr std::uint16_t k_narrow_unreachable = UINT16_MAX;
+		static constexpr std::uint32_t k_wide_unreachable = UINT32_MAX;
+
+		template <class T>
+		int lowerBound(const std::vector<T>& table, int node, int target, T unreachable) const {
+			size_t count = landmarks.size();
+			const T* from = table.data() + node * count;
+			const T* to = table.data() + target * count;
+			int best = 0;
+			for (size_t k = 0; k < count; k++) {
+				// a landmark that cannot reach both says nothing about them
+				if (from[k] == unreachable || to[k] == unreachable)
+					continue;
+				int difference = static_cast<int>(to[k]) - static_cast<int>(from[k]);
+				best = std::max(best, symmetric ? std::abs(difference) : difference);
+			}
+			return best;
+		}
+
+		/*
+		* Sizes the tables for the current landmarks, 16 bit entries when no
+		* distance can exceed them, and fills them from one distance array per
+		* landmark.
+		*/
+		template <class Graph>
+		void fillTables(const Graph& graph, const std::vector<std::vector<int>>& distances) {
+			graph_size = graph.size();
+			symmetric = graph.uniformCost();
+			int max_cost = 1;
+			for (int node = 0; node < graph_size && !symmetric; node++)
+				max_cost = std::max(max_cost, stepCost(graph, node));
+			// the longest shortest path enters every node at most once
+			bool fits = static_cast<long long>(graph_size) * max_cost < k_narrow_unreachable;
+			narrow.assign(fits ? static_cast<size_t>(graph_size) * landmarks.size() : 0, k_narrow_unreachable);
+			wide.assign(fits ? 0 : static_cast<size_t>(graph_size) * landmarks.size(), k_wide_unreachable);
+			if (fits)
+				transpose(distances, narrow, k_narrow_unreachable);
+			else
+				transpose(distances, wide, k_wide_unreachable);
+		}
+
+		/*
+		* Landmark major distances into the node major table, row by row.
+		*/
+		template <class T>
+		void transpose(const std::vector<std::vector<int>>& distances, std::vector<T>& table, T unreachable) const {
+			size_t count = landmarks.size();
+			T* row = table.data();
+			for (int node = 0; node < graph_size; node++, row += count) {
+				for (size_t k = 0; k < count; k++)
+					row[k] = distances[k][node] == INT_MAX ? unreachable : static_cast<T>(distances[k][node]);
+			}
+		}
+
+		/*
+		* Distances from source, INT_MAX where it cannot reach.
+		*/
+		template <class Graph>
+		static void distancesFrom(const Graph& graph, int source, std::vector<int>& distances) {
+			SingleSourceTree tree{};
+			singleSourceTree(graph, source, tree);
+			distances = std::move(tree.distances);
+		}
+
+		/*
+		* A random node with neighbours, -1 after too many isolated picks.
+		*/
+		template <class Graph>
+		static int randomRoot(const Graph& graph, std::mt19937& rng) {
+			if (graph.size() == 0)
+				return -1;
+			for (int attempt = 0; attempt < 1000; attempt++) {
+				int node = static_cast<int>(rng() % graph.size());
+				bool connected = false;
+				graph.forEachNeighbour(node, [&](int) { connected = true; });
+				if (connected)
+					return node;
+			}
+			return -1;
+		}
+
+		/*
+		* The node reachable from root furthest from every landmark so far,
+		* or from root itself for the first one.
+		*/
+		template <class Graph>
+		int farthestLandmark(const Graph& graph, int root, const std::vector<std::vector<int>>& distances) const {
+			std::vector<int> from_root{};
+			distancesFrom(graph, root, from_root);
+
+			int farthest = -1;
+			int farthest_distance = 0;
+			for (int node = 0; node < graph.size(); node++) {
+				if (from_root[node] == INT_MAX)
+					continue;
+				int nearest = from_root[node];
+				if (!distances.empty()) {
+					nearest = INT_MAX;
+					for (const std::vector<int>& table : distances)
+						nearest = std::min(nearest, table[node]);
+				}
+				if (farthest == -1 || (nearest != INT_MAX && nearest > farthest_distance)) {
+					farthest = node;
+					farthest_distance = nearest == INT_MAX ? 0 : nearest;
+				}
+			}
+			return farthest;
+		}
+
+		/*
+		* Weighs every node of a shortest path tree from root by how much the
+		* current landmarks underestimate its distance to root, sums the
+		* weights over subtrees without a landmark and walks down the heaviest
+		* subtrees to a leaf.
+		*/
+		template <class Graph>
+		int avoidLandmark(const Graph& graph, int root, const std::vector<std::vector<int>>& distances) const {
+			int size = graph.size();
+			SingleSourceTree tree{};
+			singleSourceTree(graph, root, tree);
+			const std::vector<int>& parents = tree.parents;
+			const std::vector<int>& order = tree.order;
+
+			std::vector<long long> sizes(size, 0);
+			std::vector<bool> covered(size, false);
+			for (int landmark : landmarks)
+				covered[landmark] = true;
+			// parents come before children, so subtrees add up in reverse order
+			for (auto it = order.rbegin(); it != order.rend(); ++it) {
+				int node = *it;
+				if (covered[node]) {
+					sizes[node] = 0;
+				}
+				else {
+					int bound = 0;
+					for (const std::vector<int>& table : distances) {
+						if (table[node] == INT_MAX || table[root] == INT_MAX)
+							continue;
+						bound = std::max(bound, std::abs(table[node] - table[root]));
+					}
+					int from_root = tree.distances[node];
+					sizes[node] += from_root - std::min(bound, from_root);
+				}
+				int parent = parents[node];
+				if (parent == -1)
+					continue;
+				if (covered[node])
+					covered[parent] = true;
+				else
+					sizes[parent] += sizes[node];
+			}
+			for (int node : order)
+				if (covered[node])
+					sizes[node] = 0;
+
+			std::vector<int> heaviest(size, -1);
+			for (int node : order) {
+				int parent = parents[node];
+				if (parent != -1 && sizes[node] > 0 && (heaviest[parent] == -1 || sizes[node] > sizes[heaviest[parent]]))
+					heaviest[parent] = node;
+			}
+			// ancestors of landmarks weigh 0, the walk leaves them at once
+			if (heaviest[root] == -1)
+				return -1;
+			int node = root;
+			while (heaviest[node] != -1)
+				node = heaviest[node];
+			return node;
+		}
+
+	private:
+		std::vector<int> landmarks;
+		int graph_size = 0;
+		bool symmetric = true;
+
+		// one of them holds the tables, node major
+		std::vector<std::uint16_t> narrow;
+		std::vector<std::uint32_t> wide;
+	};
+
+	inline int LandmarkDistance::operator()(int node, int target) const {
+		return landmarks->lowerBound(node, target);
+	}
+};
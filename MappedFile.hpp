@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <utility>
+#include <optional>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace dijkstra {
+
+	/**
+	 * A file mapped read only into memory, unmapped on destruction.
+	 *
+	 * Pages are loaded by the operating system on first access and shared
+	 * between processes mapping the same file, so opening a large
+	 * precomputed table costs nothing until it is queried.
+	 */
+	class MappedFile {
+	public:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept {
+			*this = std::move(other);
+		}
+
+		MappedFile& operator=(MappedFile&& other) noexcept {
+			if (this != &other) {
+				close();
+				std::swap(view, other.view);
+				std::swap(length, other.length);
+#ifdef _WIN32
+				std::swap(mapping, other.mapping);
+#endif
+			}
+			return *this;
+		}
+
+		~MappedFile() {
+			close();
+		}
+
+	public:
+		/*
+		* Nullopt when the file cannot be opened or is empty.
+		*/
+		static std::optional<MappedFile> open(const std::string& path) {
+			MappedFile file{};
+#ifdef _WIN32
+			HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (handle == INVALID_HANDLE_VALUE)
+				return std::nullopt;
+			LARGE_INTEGER size{};
+			if (GetFileSizeEx(handle, &size) && size.QuadPart > 0) {
+				file.mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (file.mapping != nullptr) {
+					file.view = MapViewOfFile(file.mapping, FILE_MAP_READ, 0, 0, 0);
+					file.length = static_cast<std::size_t>(size.QuadPart);
+				}
+			}
+			CloseHandle(handle);
+#else
+			int descriptor = ::open(path.c_str(), O_RDONLY);
+			if (descriptor == -1)
+				return std::nullopt;
+			struct stat status {};
+			if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+				void* address = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+				if (address != MAP_FAILED) {
+					file.view = address;
+					file.length = static_cast<std::size_t>(status.st_size);
+				}
+			}
+			::close(descriptor);
+#endif
+			if (file.view == nullptr)
+				return std::nullopt;
+			return file;
+		}
+
+		const std::byte* data() const {
+			return static_cast<const std::byte*>(view);
+		}
+
+		std::size_t size() const {
+			return length;
+		}
+
+	private:
+		MappedFile() = default;
+
+		void close() {
+#ifdef _WIN32
+			if (view != nullptr)
+				UnmapViewOfFile(view);
+			if (mapping != nullptr)
+				CloseHandle(mapping);
+			mapping = nullptr;
+#else
+			if (view != nullptr)
+				munmap(view, length);
+#endif
+			view = nullptr;
+			length = 0;
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE mapping = nullptr;
+		LPVOID view = nullptr;
+#else
+		void* view = nullptr;
+#endif
+		std::size_t length = 0;
+	};
+};
@@ -1,82 +1,126 @@
+#pragma once
+
 #include <iostream>
 #include <vector>
-#include <stack>
-#include <cstdlib>
-#include <ctime>
+#include <cstdint>
+#include <utility>
+
+#include "Random.hpp"
+#include "CostMap.hpp"
 
+// Cells are written into a sink, anything with width(), height(), fill(bool),
+// test(x, y), set(x, y) and reset(x, y) such as dijkstra::GridBitmap, where a
+// set bit is an open cell. No matrix of its own is kept: a 16k x 16k maze
+// takes the 32 MB of its bitmap plus the backtracking stack.
+//
+// Random numbers come from the Rng policy, any engine of Random.hpp. The same
+// seed gives the same maze on every platform.
+template <class Rng = dijkstra::Xoshiro256>
 class MazeGenerator {
 public:
-    MazeGenerator(int width, int height) : width(width), height(height) {
-        maze_matrix.resize(height, std::vector<int>(width, 0));
+    MazeGenerator(int width, int height, std::uint64_t seed = dijkstra::randomSeed())
+        : width(width), height(height), rng(seed) {
     }
 
-    void generate() {
+    template <class Sink>
+    void generate(Sink& cells) {
         // Start from a random cell
-        std::srand(std::time(0));
-        int startX = std::rand() % width;
-        int startY = std::rand() % height;
+        int x = dijkstra::uniformBelow(rng, width);
+        int y = dijkstra::uniformBelow(rng, height);
 
         // Initialize the maze with walls
-        for (int i = 0; i < height; ++i)
-            for (int j = 0; j < width; ++j)
-                maze_matrix[i][j] = 0;
-
-        // Create a stack to hold the cells
-        std::stack<std::pair<int, int>> cellStack;
-        cellStack.push({ startX, startY });
-        maze_matrix[startY][startX] = 1; // Mark the starting cell as a path
+        cells.fill(false);
 
-        while (!cellStack.empty()) {
-            std::pair<int, int> current = cellStack.top();
-            int x = current.first;
-            int y = current.second;
+        // The stack holds the step that led to each cell, 2 bits per cell,
+        // which is enough to walk back to the previous one
+        DirectionStack stack;
+        cells.set(x, y); // Mark the starting cell as a path
 
+        while (true) {
             // Get the list of unvisited neighbors
-            std::vector<std::pair<int, int>> neighbors;
-            if (x > 1 && maze_matrix[y][x - 2] == 0)
-                neighbors.push_back({ x - 2, y });
-            if (x < width - 2 && maze_matrix[y][x + 2] == 0)
-                neighbors.push_back({ x + 2, y });
-            if (y > 1 && maze_matrix[y - 2][x] == 0)
-                neighbors.push_back({ x, y - 2 });
-            if (y < height - 2 && maze_matrix[y + 2][x] == 0)
-                neighbors.push_back({ x, y + 2 });
-
-            if (!neighbors.empty()) {
+            int neighbors[4];
+            int count = 0;
+            for (int direction = 0; direction < 4; ++direction) {
+                int nextX = x + 2 * dx[direction];
+                int nextY = y + 2 * dy[direction];
+                if (nextX >= 0 && nextX < width && nextY >= 0 && nextY < height && !cells.test(nextX, nextY))
+                    neighbors[count++] = direction;
+            }
+
+            if (count > 0) {
                 // Choose a random neighbor
-                int randIndex = std::rand() % neighbors.size();
-                std::pair<int, int> next = neighbors[randIndex];
+                int direction = neighbors[dijkstra::uniformBelow(rng, count)];
 
                 // Remove the wall between the current cell and the chosen neighbor
-                int newX = next.first;
-                int newY = next.second;
-                maze_matrix[(y + newY) / 2][(x + newX) / 2] = 1;
-                maze_matrix[newY][newX] = 1;
+                cells.set(x + dx[direction], y + dy[direction]);
+                x += 2 * dx[direction];
+                y += 2 * dy[direction];
+                cells.set(x, y);
 
-                // Push the chosen neighbor to the stack
-                cellStack.push(next);
+                // Push the step to the chosen neighbor on the stack
+                stack.push(direction);
             }
-            else {
+            else if (!stack.empty()) {
                 // Backtrack
-                cellStack.pop();
+                int direction = stack.pop();
+                x -= 2 * dx[direction];
+                y -= 2 * dy[direction];
+            }
+            else {
+                break;
             }
         }
     }
 
-    void printMaze() {
-        for (const auto& row : maze_matrix) {
-            for (int cell : row) {
-                std::cout << (cell == 1 ? " " : "#");
+    // Terrain costs for the open cells of the sink, patches of patch_size
+    // cells drawn from this generator's engine, see dijkstra::generatePatchCosts.
+    template <class Sink, class SetCost>
+    void generateCosts(const Sink& cells, int max_cost, SetCost&& setCost, int patch_size = 8) {
+        dijkstra::generatePatchCosts(rng, cells, max_cost, std::forward<SetCost>(setCost), patch_size);
+    }
+
+    template <class Sink>
+    void printMaze(const Sink& cells) {
+        for (int i = 0; i < height; ++i) {
+            for (int j = 0; j < width; ++j) {
+                std::cout << (cells.test(j, i) ? " " : "#");
             }
             std::cout << std::endl;
         }
     }
 
-    const std::vector<std::vector<int>>& mazeMatrix() {
-        return maze_matrix;
-    }
-
 private:
+    // Left, right, up, down
+    static constexpr int dx[4] = { -1, 1, 0, 0 };
+    static constexpr int dy[4] = { 0, 0, -1, 1 };
+
+    class DirectionStack {
+    public:
+        bool empty() const {
+            return depth == 0;
+        }
+
+        void push(int direction) {
+            if (depth % 4 == 0)
+                packed.push_back(0);
+            packed.back() |= static_cast<std::uint8_t>(direction << (depth % 4 * 2));
+            ++depth;
+        }
+
+        int pop() {
+            --depth;
+            int direction = (packed.back() >> (depth % 4 * 2)) & 3;
+            packed.back() &= static_cast<std::uint8_t>(~(3 << (depth % 4 * 2)));
+            if (depth % 4 == 0)
+                packed.pop_back();
+            return direction;
+        }
+
+    private:
+        std::vector<std::uint8_t> packed;
+        size_t depth = 0;
+    };
+
     int width, height;
-    std::vector<std::vector<int>> maze_matrix;
-};
\ No newline at end of file
+    Rng rng;
+};
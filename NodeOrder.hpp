@@ -0,0 +1,222 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define DIJKSTRA_HAS_PDEP 1
+#endif
+
+namespace dijkstra {
+
+	/*
+	* Node orders number the cells of a grid_width x grid_height grid. Every
+	* order gives index(x, y) and its inverse x(node), y(node), and size(), the
+	* number of node ids it uses; orders that pad the grid leave some ids
+	* without a cell, which graphs keep as isolated nodes.
+	*/
+
+	/**
+	 * Row by row, the layout nodeIndex() describes. Neighbours along a row
+	 * share cache lines, neighbours along a column are a whole row apart.
+	 */
+	struct RowMajorOrder {
+		int grid_width = 0;
+		int grid_height = 0;
+
+		RowMajorOrder() = default;
+
+		RowMajorOrder(int grid_width, int grid_height)
+			:grid_width(grid_width), grid_height(grid_height) {
+		}
+
+		int width() const {
+			return grid_width;
+		}
+
+		int height() const {
+			return grid_height;
+		}
+
+		int size() const {
+			return grid_width * grid_height;
+		}
+
+		int index(int x, int y) const {
+			return x + y * grid_width;
+		}
+
+		int x(int node) const {
+			return node % grid_width;
+		}
+
+		int y(int node) const {
+			return node / grid_width;
+		}
+	};
+
+	/*
+	* Moves the low 16 bits of value to the even bit positions.
+	*/
+	inline std::uint32_t spreadBits(std::uint32_t value) {
+#ifdef DIJKSTRA_HAS_PDEP
+		return _pdep_u32(value, 0x55555555u);
+#else
+		value &= 0x0000ffffu;
+		value = (value | value << 8) & 0x00ff00ffu;
+		value = (value | value << 4) & 0x0f0f0f0fu;
+		value = (value | value << 2) & 0x33333333u;
+		value = (value | value << 1) & 0x55555555u;
+		return value;
+#endif
+	}
+
+	/*
+	* Inverse of spreadBits: gathers the even bits of value.
+	*/
+	inline std::uint32_t compactBits(std::uint32_t value) {
+#ifdef DIJKSTRA_HAS_PDEP
+		return _pext_u32(value, 0x55555555u);
+#else
+		value &= 0x55555555u;
+		value = (value | value >> 1) & 0x33333333u;
+		value = (value | value >> 2) & 0x0f0f0f0fu;
+		value = (value | value >> 4) & 0x00ff00ffu;
+		value = (value | value >> 8) & 0x0000ffffu;
+		return value;
+#endif
+	}
+
+	/**
+	 * Z-order: the bits of x and y interleaved, so every aligned square of
+	 * 2^k x 2^k cells is a contiguous range of ids and neighbours along both
+	 * axes are mostly close. Interleaving uses pdep/pext when BMI2 is
+	 * available.
+	 *
+	 * Each axis is padded to a power of two. On a non square grid the low
+	 * bits of both axes are interleaved and the remaining high bits of the
+	 * longer one go on top, so a 2048 x 1024 grid pads nothing while a
+	 * 1000 x 1000 one uses 1024 x 1024 ids. Ids are ints: the padded grid
+	 * holds at most 2^30 cells.
+	 */
+	struct MortonOrder {
+		int grid_width = 0;
+		int grid_height = 0;
+		int x_bits = 0;
+		int y_bits = 0;
+		// bits of both axes that are interleaved
+		int shared_bits = 0;
+
+		MortonOrder() = default;
+
+		MortonOrder(int grid_width, int grid_height)
+			:grid_width(grid_width), grid_height(grid_height),
+			x_bits(std::bit_width(static_cast<unsigned>(std::max(grid_width - 1, 0)))),
+			y_bits(std::bit_width(static_cast<unsigned>(std::max(grid_height - 1, 0)))),
+			shared_bits(std::min(x_bits, y_bits)) {
+		}
+
+		int width() const {
+			return grid_width;
+		}
+
+		int height() const {
+			return grid_height;
+		}
+
+		int size() const {
+			return grid_width > 0 && grid_height > 0 ? 1 << (x_bits + y_bits) : 0;
+		}
+
+		int index(int x, int y) const {
+			std::uint32_t mask = (1u << shared_bits) - 1;
+			std::uint32_t low = spreadBits(x & mask) | spreadBits(y & mask) << 1;
+			// at most one axis has bits left over
+			std::uint32_t high = static_cast<std::uint32_t>(x >> shared_bits | y >> shared_bits);
+			return static_cast<int>(high << 2 * shared_bits | low);
+		}
+
+		int x(int node) const {
+			int low = static_cast<int>(compactBits(static_cast<std::uint32_t>(node)) & ((1u << shared_bits) - 1));
+			return x_bits > shared_bits ? (node >> 2 * shared_bits) << shared_bits | low : low;
+		}
+
+		int y(int node) const {
+			int low = static_cast<int>(compactBits(static_cast<std::uint32_t>(node) >> 1) & ((1u << shared_bits) - 1));
+			return y_bits > shared_bits ? (node >> 2 * shared_bits) << shared_bits | low : low;
+		}
+	};
+
+	/**
+	 * Tiles of Tile x Tile cells, row major inside each tile and tiles row
+	 * major across the grid. With the default 8 x 8 tiles of int sized
+	 * entries a tile row is half a cache line and the whole tile four of
+	 * them, so a search front stays within few lines in both directions.
+	 * The grid is padded to whole tiles.
+	 */
+	template <int Tile = 8>
+	struct TiledOrder {
+		static_assert(Tile > 0 && (Tile & (Tile - 1)) == 0, "tiles must be a power of two wide");
+		static constexpr int k_shift = std::countr_zero(static_cast<unsigned>(Tile));
+
+		int grid_width = 0;
+		int grid_height = 0;
+		int tiles_across = 0;
+		int tiles_down = 0;
+
+		TiledOrder() = default;
+
+		TiledOrder(int grid_width, int grid_height)
+			:grid_width(grid_width), grid_height(grid_height),
+			tiles_across((grid_width + Tile - 1) >> k_shift), tiles_down((grid_height + Tile - 1) >> k_shift) {
+		}
+
+		int width() const {
+			return grid_width;
+		}
+
+		int height() const {
+			return grid_height;
+		}
+
+		int size() const {
+			return tiles_across * tiles_down * Tile * Tile;
+		}
+
+		int index(int x, int y) const {
+			int tile = (y >> k_shift) * tiles_across + (x >> k_shift);
+			return tile << 2 * k_shift | (y & (Tile - 1)) << k_shift | (x & (Tile - 1));
+		}
+
+		int x(int node) const {
+			return ((node >> 2 * k_shift) % tiles_across) << k_shift | (node & (Tile - 1));
+		}
+
+		int y(int node) const {
+			return ((node >> 2 * k_shift) / tiles_across) << k_shift | ((node >> k_shift) & (Tile - 1));
+		}
+	};
+
+	/*
+	* The order a grid graph numbers its cells in: its order() when it has
+	* one, row major otherwise.
+	*/
+	template <class Graph>
+	auto gridOrder(const Graph& graph) {
+		if constexpr (requires { graph.order(); })
+			return graph.order();
+		else
+			return RowMajorOrder(graph.width(), graph.height());
+	}
+
+	/*
+	* Grid graphs numbering their cells row major, graphs without order()
+	* included. Modules that decode ids as node % width require it.
+	*/
+	template <class Graph>
+	concept RowMajorGrid = std::is_same_v<decltype(gridOrder(std::declval<const Graph&>())), RowMajorOrder>;
+};
@@ -2,44 +2,119 @@
 
 #include <iostream>
 #include <vector>
-#include <queue>
-#include <cstdlib>
-#include <ctime>
+#include <cstdint>
 #include <utility>
-#include <limits>
+#include <algorithm>
 
-// ObstacleGenerator class to generate a grid with obstacles
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "Random.hpp"
+#include "CostMap.hpp"
+#include "GridBitmap.hpp"
+#include "Parallel.hpp"
+
+// ObstacleGenerator class to generate a grid with obstacles.
+// Cells are written into a sink, anything with width(), height(), test(x, y),
+// set(x, y) and reset(x, y) such as dijkstra::GridBitmap, where a set bit is
+// an open cell and obstaclePercentage of the cells are left blocked.
+//
+// Random numbers come from the Rng policy, any engine of Random.hpp. The same
+// seed gives the same grid on every platform.
+template <class Rng = dijkstra::Xoshiro256>
 class ObstacleGenerator {
 public:
-    ObstacleGenerator(int width, int height, int obstaclePercentage)
-        : width(width), height(height), obstaclePercentage(obstaclePercentage) {
-        maze.resize(height, std::vector<int>(width, 0));
+    ObstacleGenerator(int width, int height, int obstaclePercentage, std::uint64_t seed = dijkstra::randomSeed())
+        : width(width), height(height), obstaclePercentage(obstaclePercentage), seed(seed), rng(seed) {
     }
 
-    void generate() {
-        std::srand(std::time(0));
-
+    template <class Sink>
+    void generate(Sink& cells) {
         for (int i = 0; i < height; ++i) {
             for (int j = 0; j < width; ++j) {
-                maze[i][j] = (std::rand() % 100 < obstaclePercentage) ? 1 : 0;
+                if (static_cast<int>(dijkstra::uniformBelow(rng, 100)) < obstaclePercentage)
+                    cells.reset(j, i);
+                else
+                    cells.set(j, i);
             }
         }
     }
 
-    void printMaze() {
-        for (const auto& row : maze) {
-            for (int cell : row) {
-                std::cout << (cell == 1 ? "#" : ".");
+    // Bulk version of generate() for a GridBitmap, whole 64 cell words at a
+    // time with rows spread over threads (0 = one per hardware thread).
+    // Every word draws 64 lanes of 16 bits from Philox blocks numbered by its
+    // position and blocks the cells whose lane falls below the threshold, so
+    // the grid depends on the seed only, not on the thread count or the Rng
+    // policy. Percentages are exact to 1 / 65536.
+    void generateRows(dijkstra::GridBitmap& cells, int threads = 0) {
+        dijkstra::Philox4x32 philox(seed);
+        std::uint32_t threshold = static_cast<std::uint32_t>((std::clamp(obstaclePercentage, 0, 100) * 65536 + 50) / 100);
+        int row_words = cells.rowWords();
+
+        dijkstra::parallelFor(dijkstra::workerCount(threads), height, [&](int, int i) {
+            dijkstra::GridBitmap::Word* row = cells.row(i);
+            for (int word = 0; word < row_words; ++word) {
+                std::uint64_t counter = static_cast<std::uint64_t>(i) * row_words + word;
+                row[word] = ~blockedCells(philox, counter, threshold);
+            }
+            row[row_words - 1] &= cells.lastWordMask();
+        });
+    }
+
+    // Terrain costs for the open cells of the sink, patches of patch_size
+    // cells drawn from this generator's engine, see dijkstra::generatePatchCosts.
+    template <class Sink, class SetCost>
+    void generateCosts(const Sink& cells, int max_cost, SetCost&& setCost, int patch_size = 8) {
+        dijkstra::generatePatchCosts(rng, cells, max_cost, std::forward<SetCost>(setCost), patch_size);
+    }
+
+    template <class Sink>
+    void printMaze(const Sink& cells) {
+        for (int i = 0; i < height; ++i) {
+            for (int j = 0; j < width; ++j) {
+                std::cout << (cells.test(j, i) ? "." : "#");
             }
             std::cout << std::endl;
         }
     }
 
-    const std::vector<std::vector<int>>& matrix() const {
-        return maze;
+private:
+    // Bit per lane below threshold, from the 8 Philox blocks of one word.
+    static std::uint64_t blockedCells(const dijkstra::Philox4x32& philox, std::uint64_t word, std::uint32_t threshold) {
+        if (threshold == 0)
+            return 0;
+        if (threshold > 0xffff)
+            return ~std::uint64_t{ 0 };
+
+        alignas(16) std::uint16_t lanes[64];
+        for (int block = 0; block < 8; ++block) {
+            dijkstra::Philox4x32::Block bits = philox.block(word * 8 + block);
+            for (int k = 0; k < 4; ++k) {
+                lanes[block * 8 + k * 2] = static_cast<std::uint16_t>(bits[k]);
+                lanes[block * 8 + k * 2 + 1] = static_cast<std::uint16_t>(bits[k] >> 16);
+            }
+        }
+
+        std::uint64_t blocked = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        // signed compares only, so both sides are shifted by 2^15
+        const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+        const __m128i limit = _mm_set1_epi16(static_cast<short>(threshold ^ 0x8000));
+        for (int lane = 0; lane < 64; lane += 16) {
+            __m128i low = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes + lane)), bias);
+            __m128i high = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes + lane + 8)), bias);
+            __m128i below = _mm_packs_epi16(_mm_cmplt_epi16(low, limit), _mm_cmplt_epi16(high, limit));
+            blocked |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(below))) << lane;
+        }
+#else
+        for (int lane = 0; lane < 64; ++lane)
+            blocked |= static_cast<std::uint64_t>(lanes[lane] < threshold) << lane;
+#endif
+        return blocked;
     }
 
-private:
     int width, height, obstaclePercentage;
-    std::vector<std::vector<int>> maze;
+    std::uint64_t seed;
+    Rng rng;
 };
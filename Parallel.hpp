@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+namespace dijkstra {
+
+	/*
+	* Worker count for threads = 0: one per hardware thread.
+	*/
+	inline int workerCount(int threads) {
+		if (threads > 0)
+			return threads;
+		return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+
+	/*
+	* Runs fn(thread, i) for every i below count, interleaved over the
+	* threads. Small loops stay on the calling thread, where starting the
+	* workers would cost more than the work.
+	*/
+	template <class Fn>
+	void parallelFor(int threads, int count, Fn&& fn) {
+		threads = std::min(threads, std::max(1, count / 64));
+		if (threads <= 1) {
+			for (int i = 0; i < count; i++)
+				fn(0, i);
+			return;
+		}
+
+		std::vector<std::thread> workers{};
+		for (int t = 0; t < threads; t++) {
+			workers.emplace_back([&, t] {
+				for (int i = t; i < count; i += threads)
+					fn(t, i);
+			});
+		}
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+};
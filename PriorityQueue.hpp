@@ -0,0 +1,554 @@
+#pragma once
+
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <climits>
+#include <cassert>
+#include <algorithm>
+
+namespace dijkstra {
+
+	/*
+	* Priority queue policies for the heap based search engines.
+	*
+	* Every policy orders nodes by a packed 64 bit key and provides:
+	*   resize(size)    nodes are in [0, size)
+	*   clear()         drops every queued node
+	*   empty()
+	*   push(key, node) queues node, or lowers its key if it is already queued
+	*                   with a larger one (lazy policies queue a duplicate)
+	*   pop()           removes and returns the entry with the smallest key
+	*   key(primary, tie_break) packs the ordering used by the policy
+	*
+	* Engines skip entries whose key no longer matches the node's distance,
+	* which only happens with lazy policies.
+	*/
+
+	using PriorityKey = std::uint64_t;
+
+	struct QueueEntry {
+		PriorityKey key;
+		int node;
+	};
+
+	/*
+	* Primary value in the high half, tie break in the low half. Both must be
+	* non negative.
+	*/
+	inline PriorityKey packKey(int primary, int tie_break) {
+		return (static_cast<PriorityKey>(primary) << 32) | static_cast<std::uint32_t>(tie_break);
+	}
+
+	inline int keyPrimary(PriorityKey key) {
+		return static_cast<int>(key >> 32);
+	}
+
+	/**
+	 * Binary heap with lazy deletion: an improved node is queued again and the
+	 * old entry is skipped when popped. Smallest constant factors, but the heap
+	 * can hold several entries per node on dense relaxation patterns.
+	 */
+	class BinaryHeap {
+	public:
+		static PriorityKey key(int primary, int tie_break) {
+			return packKey(primary, tie_break);
+		}
+
+		void resize(int) {
+		}
+
+		void clear() {
+			entries.clear();
+		}
+
+		bool empty() const {
+			return entries.empty();
+		}
+
+		void push(PriorityKey key, int node) {
+			entries.push_back({ key, node });
+			std::push_heap(entries.begin(), entries.end(), later);
+		}
+
+		QueueEntry pop() {
+			std::pop_heap(entries.begin(), entries.end(), later);
+			QueueEntry top = entries.back();
+			entries.pop_back();
+			return top;
+		}
+
+	private:
+		// on equal keys the smaller node goes first, so results do not depend on push order
+		static bool later(const QueueEntry& a, const QueueEntry& b) {
+			return a.key > b.key || (a.key == b.key && a.node > b.node);
+		}
+
+	private:
+		std::vector<QueueEntry> entries;
+	};
+
+	/**
+	 * Indexed 4-ary heap with decrease-key. Every node is queued at most once,
+	 * so the heap never holds more than V entries. Four children per node
+	 * halve the depth of a binary heap and the children share a cache line.
+	 */
+	class QuaternaryHeap {
+	public:
+		static PriorityKey key(int primary, int tie_break) {
+			return packKey(primary, tie_break);
+		}
+
+		void resize(int size) {
+			entries.clear();
+			positions.assign(size, -1);
+		}
+
+		void clear() {
+			for (const QueueEntry& entry : entries)
+				positions[entry.node] = -1;
+			entries.clear();
+		}
+
+		bool empty() const {
+			return entries.empty();
+		}
+
+		void push(PriorityKey key, int node) {
+			int position = positions[node];
+			if (position == -1) {
+				position = static_cast<int>(entries.size());
+				entries.push_back({ key, node });
+			}
+			else if (key < entries[position].key)
+				entries[position].key = key;
+			else
+				return;
+			siftUp(position);
+		}
+
+		QueueEntry pop() {
+			QueueEntry top = entries.front();
+			remove(top.node);
+			return top;
+		}
+
+		/*
+		* Full indexed access, for searches that also raise keys or drop nodes.
+		*/
+		bool contains(int node) const {
+			return positions[node] != -1;
+		}
+
+		const QueueEntry& top() const {
+			return entries.front();
+		}
+
+		void remove(int node) {
+			int position = positions[node];
+			positions[node] = -1;
+
+			QueueEntry last = entries.back();
+			entries.pop_back();
+			if (position == static_cast<int>(entries.size()))
+				return;
+
+			place(position, last);
+			siftUp(position);
+			siftDown(positions[last.node]);
+		}
+
+		/*
+		* Sets the key of node, up or down, queuing it if needed.
+		*/
+		void update(PriorityKey key, int node) {
+			int position = positions[node];
+			if (position == -1) {
+				push(key, node);
+				return;
+			}
+			entries[position].key = key;
+			siftUp(position);
+			siftDown(positions[node]);
+		}
+
+	private:
+		static bool before(const QueueEntry& a, const QueueEntry& b) {
+			return a.key < b.key || (a.key == b.key && a.node < b.node);
+		}
+
+		void place(int position, const QueueEntry& entry) {
+			entries[position] = entry;
+			positions[entry.node] = position;
+		}
+
+		void siftUp(int position) {
+			QueueEntry entry = entries[position];
+			while (position > 0) {
+				int parent = (position - 1) / 4;
+				if (!before(entry, entries[parent]))
+					break;
+				place(position, entries[parent]);
+				position = parent;
+			}
+			place(position, entry);
+		}
+
+		void siftDown(int position) {
+			QueueEntry entry = entries[position];
+			int size = static_cast<int>(entries.size());
+			for (;;) {
+				int first = position * 4 + 1;
+				if (first >= size)
+					break;
+
+				int best = first;
+				int last = std::min(first + 4, size);
+				for (int child = first + 1; child < last; child++)
+					if (before(entries[child], entries[best]))
+						best = child;
+
+				if (!before(entries[best], entry))
+					break;
+				place(position, entries[best]);
+				position = best;
+			}
+			place(position, entry);
+		}
+
+	private:
+		std::vector<QueueEntry> entries;
+		std::vector<int> positions;
+	};
+
+	/**
+	 * Pairing heap with decrease-key over per node links. Push and
+	 * decrease-key are O(1), pop is amortized O(log V) with the two pass
+	 * merge. Membership is generation stamped, so clear() is O(1).
+	 */
+	class PairingHeap {
+	public:
+		static PriorityKey key(int primary, int tie_break) {
+			return packKey(primary, tie_break);
+		}
+
+		void resize(int size) {
+			nodes.assign(size, HeapNode{});
+			generation = 1;
+			root = -1;
+		}
+
+		void clear() {
+			root = -1;
+			if (++generation == 0) {
+				for (HeapNode& node : nodes)
+					node.stamp = 0;
+				generation = 1;
+			}
+		}
+
+		bool empty() const {
+			return root == -1;
+		}
+
+		void push(PriorityKey key, int node) {
+			HeapNode& heap_node = nodes[node];
+			if (heap_node.stamp != generation) {
+				heap_node = HeapNode{ generation, key, -1, -1, -1 };
+				root = root == -1 ? node : meld(root, node);
+				return;
+			}
+
+			if (key >= heap_node.key)
+				return;
+			heap_node.key = key;
+			if (node == root)
+				return;
+
+			// cut the subtree rooted at node and meld it back with the root
+			int previous = heap_node.previous;
+			if (nodes[previous].child == node)
+				nodes[previous].child = heap_node.sibling;
+			else
+				nodes[previous].sibling = heap_node.sibling;
+			if (heap_node.sibling != -1)
+				nodes[heap_node.sibling].previous = previous;
+			heap_node.sibling = -1;
+			heap_node.previous = -1;
+			root = meld(root, node);
+		}
+
+		QueueEntry pop() {
+			int top = root;
+			QueueEntry entry{ nodes[top].key, top };
+			nodes[top].stamp = 0;
+			root = mergePairs(nodes[top].child);
+			return entry;
+		}
+
+	private:
+		struct HeapNode {
+			std::uint32_t stamp = 0;
+			PriorityKey key = 0;
+			int child = -1;
+			int sibling = -1;
+			// parent for the leftmost child, left sibling otherwise
+			int previous = -1;
+		};
+
+		bool before(int a, int b) const {
+			return nodes[a].key < nodes[b].key || (nodes[a].key == nodes[b].key && a < b);
+		}
+
+		/*
+		* Links two roots, the larger one becomes the leftmost child.
+		*/
+		int meld(int a, int b) {
+			if (before(b, a))
+				std::swap(a, b);
+			HeapNode& parent = nodes[a];
+			HeapNode& child = nodes[b];
+			child.sibling = parent.child;
+			if (parent.child != -1)
+				nodes[parent.child].previous = b;
+			child.previous = a;
+			parent.child = b;
+			return a;
+		}
+
+		int mergePairs(int first) {
+			if (first == -1)
+				return -1;
+
+			pairs.clear();
+			while (first != -1) {
+				int a = first;
+				int b = nodes[a].sibling;
+				first = b != -1 ? nodes[b].sibling : -1;
+
+				nodes[a].sibling = nodes[a].previous = -1;
+				if (b != -1) {
+					nodes[b].sibling = nodes[b].previous = -1;
+					a = meld(a, b);
+				}
+				pairs.push_back(a);
+			}
+
+			int merged = pairs.back();
+			for (int i = static_cast<int>(pairs.size()) - 2; i >= 0; i--)
+				merged = meld(pairs[i], merged);
+			return merged;
+		}
+
+	private:
+		std::vector<HeapNode> nodes;
+		std::vector<int> pairs;
+		std::uint32_t generation = 1;
+		int root = -1;
+	};
+
+	/**
+	 * Monotone radix heap with decrease-key. Keys go to the bucket of the
+	 * highest bit where they differ from the last popped key, and a bucket is
+	 * only redistributed when everything below it is empty, so each entry
+	 * moves at most 64 times. Every node is queued at most once.
+	 *
+	 * Keys pushed must not be smaller than the last popped one. That holds for
+	 * distances in Dijkstra and for estimates of A* with a consistent
+	 * heuristic, but not for the tie break towards the target, so key() keeps
+	 * the primary value only.
+	 */
+	class RadixHeap {
+	public:
+		static PriorityKey key(int primary, int) {
+			return packKey(primary, 0);
+		}
+
+		void resize(int size) {
+			clear();
+			locations.assign(size, Location{});
+		}
+
+		void clear() {
+			for (std::vector<QueueEntry>& bucket : buckets) {
+				for (const QueueEntry& entry : bucket)
+					locations[entry.node].bucket = -1;
+				bucket.clear();
+			}
+			last = 0;
+			count = 0;
+		}
+
+		bool empty() const {
+			return count == 0;
+		}
+
+		void push(PriorityKey key, int node) {
+			Location& location = locations[node];
+			if (location.bucket != -1) {
+				if (key >= buckets[location.bucket][location.index].key)
+					return;
+				remove(node);
+			}
+			insert(key, node);
+			count++;
+		}
+
+		QueueEntry pop() {
+			if (buckets[0].empty())
+				redistribute();
+
+			QueueEntry top = buckets[0].back();
+			buckets[0].pop_back();
+			locations[top.node].bucket = -1;
+			count--;
+			return top;
+		}
+
+	private:
+		struct Location {
+			int bucket = -1;
+			int index = 0;
+		};
+
+		int bucketOf(PriorityKey key) const {
+			return key == last ? 0 : 64 - std::countl_zero(key ^ last);
+		}
+
+		void insert(PriorityKey key, int node) {
+			std::vector<QueueEntry>& bucket = buckets[bucketOf(key)];
+			locations[node] = { bucketOf(key), static_cast<int>(bucket.size()) };
+			bucket.push_back({ key, node });
+		}
+
+		void remove(int node) {
+			Location location = locations[node];
+			std::vector<QueueEntry>& bucket = buckets[location.bucket];
+			bucket[location.index] = bucket.back();
+			locations[bucket[location.index].node].index = location.index;
+			bucket.pop_back();
+			locations[node].bucket = -1;
+			count--;
+		}
+
+		/*
+		* Moves the first non empty bucket down, with its minimum as the new
+		* last key; the minimum lands in bucket 0.
+		*/
+		void redistribute() {
+			int i = 1;
+			while (buckets[i].empty())
+				i++;
+
+			std::vector<QueueEntry>& bucket = buckets[i];
+			last = std::min_element(bucket.begin(), bucket.end(), [](const QueueEntry& a, const QueueEntry& b) {
+				return a.key < b.key;
+			})->key;
+
+			moving.swap(bucket);
+			for (const QueueEntry& entry : moving)
+				insert(entry.key, entry.node);
+			moving.clear();
+		}
+
+	private:
+		std::vector<QueueEntry> buckets[65];
+		std::vector<QueueEntry> moving;
+		std::vector<Location> locations;
+		PriorityKey last = 0;
+		int count = 0;
+	};
+
+	/**
+	 * Dial's bucket queue for small integer step costs: one bucket per key in
+	 * a circular array, so push and decrease-key are O(1) and popping only
+	 * walks forward over empty buckets. A whole search is O(V + C) for keys
+	 * up to C, without any comparisons.
+	 *
+	 * Like RadixHeap keys must not be smaller than the last popped one and the
+	 * tie break is dropped. Keys alive at once must also span less than
+	 * k_buckets, which covers a step of 255 plus the heuristic change of A*.
+	 */
+	class BucketQueue {
+	public:
+		static constexpr int k_buckets = 512;
+
+		static PriorityKey key(int primary, int) {
+			return packKey(primary, 0);
+		}
+
+		void resize(int size) {
+			clear();
+			locations.assign(size, Location{});
+		}
+
+		void clear() {
+			for (std::vector<int>& bucket : buckets) {
+				for (int node : bucket)
+					locations[node].bucket = -1;
+				bucket.clear();
+			}
+			current = 0;
+			count = 0;
+		}
+
+		bool empty() const {
+			return count == 0;
+		}
+
+		void push(PriorityKey key, int node) {
+			int primary = keyPrimary(key);
+			// current is where pop starts scanning, never past a queued key
+			if (count == 0 || primary < current)
+				current = primary;
+			assert(primary - current < k_buckets);
+
+			Location& location = locations[node];
+			if (location.bucket != -1) {
+				if (primary >= location.primary)
+					return;
+				remove(node);
+			}
+
+			std::vector<int>& bucket = buckets[primary & (k_buckets - 1)];
+			location = { primary & (k_buckets - 1), static_cast<int>(bucket.size()), primary };
+			bucket.push_back(node);
+			count++;
+		}
+
+		QueueEntry pop() {
+			while (buckets[current & (k_buckets - 1)].empty())
+				current++;
+
+			std::vector<int>& bucket = buckets[current & (k_buckets - 1)];
+			int node = bucket.back();
+			bucket.pop_back();
+			locations[node].bucket = -1;
+			count--;
+			return { packKey(current, 0), node };
+		}
+
+	private:
+		struct Location {
+			int bucket = -1;
+			int index = 0;
+			int primary = 0;
+		};
+
+		void remove(int node) {
+			Location location = locations[node];
+			std::vector<int>& bucket = buckets[location.bucket];
+			bucket[location.index] = bucket.back();
+			locations[bucket[location.index]].index = location.index;
+			bucket.pop_back();
+			locations[node].bucket = -1;
+			count--;
+		}
+
+	private:
+		std::vector<int> buckets[k_buckets];
+		std::vector<Location> locations;
+		int current = 0;
+		int count = 0;
+	};
+};
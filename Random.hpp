@@ -0,0 +1,208 @@
+#pragma once
+
+#include <bit>
+#include <array>
+#include <limits>
+#include <random>
+#include <cstdint>
+
+namespace dijkstra {
+
+	/*
+	* Engines below are UniformRandomBitGenerators, usable with the standard
+	* distributions, and produce the same sequence for the same seed on
+	* every platform, unlike std::rand() or the standard distributions.
+	*/
+
+	/*
+	* SplitMix64 step, spreads a seed over the state of the other engines.
+	*/
+	inline std::uint64_t splitMix64(std::uint64_t& state) {
+		std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	/*
+	* A seed from the operating system, for callers that do not need to
+	* reproduce a run.
+	*/
+	inline std::uint64_t randomSeed() {
+		std::random_device device;
+		return static_cast<std::uint64_t>(device()) << 32 | device();
+	}
+
+	/**
+	 * xoshiro256** by Blackman and Vigna: 256 bits of state, a few shifts,
+	 * rotations and two multiplications per 64 bit output.
+	 */
+	class Xoshiro256 {
+	public:
+		using result_type = std::uint64_t;
+
+		explicit Xoshiro256(std::uint64_t seed = 0) {
+			for (std::uint64_t& word : state)
+				word = splitMix64(seed);
+		}
+
+	public:
+		static constexpr result_type min() {
+			return 0;
+		}
+
+		static constexpr result_type max() {
+			return std::numeric_limits<result_type>::max();
+		}
+
+		result_type operator()() {
+			std::uint64_t result = std::rotl(state[1] * 5, 7) * 9;
+			std::uint64_t t = state[1] << 17;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = std::rotl(state[3], 45);
+			return result;
+		}
+
+	private:
+		std::array<std::uint64_t, 4> state{};
+	};
+
+	/**
+	 * PCG32 (XSH RR) by O'Neill: a 64 bit linear congruential state with a
+	 * permuted 32 bit output. Streams with different stream ids never overlap.
+	 */
+	class Pcg32 {
+	public:
+		using result_type = std::uint32_t;
+
+		explicit Pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0)
+			:increment(stream << 1 | 1) {
+			(*this)();
+			state += seed;
+			(*this)();
+		}
+
+	public:
+		static constexpr result_type min() {
+			return 0;
+		}
+
+		static constexpr result_type max() {
+			return std::numeric_limits<result_type>::max();
+		}
+
+		result_type operator()() {
+			std::uint64_t old = state;
+			state = old * 6364136223846793005ull + increment;
+			std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+			return std::rotr(xorshifted, static_cast<int>(old >> 59));
+		}
+
+	private:
+		std::uint64_t state = 0;
+		std::uint64_t increment;
+	};
+
+	/**
+	 * Philox4x32-10 by Salmon et al., counter based: the output is a keyed
+	 * hash of a 128 bit counter, so block(counter) of any counter can be
+	 * computed directly. Threads filling parts of one result each compute
+	 * the blocks of their part and get the same bits whatever the split.
+	 *
+	 * As an engine it walks the counters from 0 and hands out four 32 bit
+	 * words per block.
+	 */
+	class Philox4x32 {
+	public:
+		using result_type = std::uint32_t;
+		using Block = std::array<std::uint32_t, 4>;
+
+		explicit Philox4x32(std::uint64_t seed = 0)
+			:key{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) } {
+		}
+
+	public:
+		static constexpr result_type min() {
+			return 0;
+		}
+
+		static constexpr result_type max() {
+			return std::numeric_limits<result_type>::max();
+		}
+
+		/*
+		* The four words of block counter, counter = high << 64 | low.
+		*/
+		Block block(std::uint64_t low, std::uint64_t high = 0) const {
+			Block counter{
+				static_cast<std::uint32_t>(low), static_cast<std::uint32_t>(low >> 32),
+				static_cast<std::uint32_t>(high), static_cast<std::uint32_t>(high >> 32)
+			};
+			std::uint32_t k0 = key[0];
+			std::uint32_t k1 = key[1];
+			for (int round = 0; round < 10; round++) {
+				std::uint64_t product0 = static_cast<std::uint64_t>(k_multiplier0) * counter[0];
+				std::uint64_t product1 = static_cast<std::uint64_t>(k_multiplier1) * counter[2];
+				counter = {
+					static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ k0,
+					static_cast<std::uint32_t>(product1),
+					static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ k1,
+					static_cast<std::uint32_t>(product0),
+				};
+				k0 += k_weyl0;
+				k1 += k_weyl1;
+			}
+			return counter;
+		}
+
+		result_type operator()() {
+			if (used == 4) {
+				buffer = block(next++);
+				used = 0;
+			}
+			return buffer[used++];
+		}
+
+	private:
+		static constexpr std::uint32_t k_multiplier0 = 0xd2511f53;
+		static constexpr std::uint32_t k_multiplier1 = 0xcd9e8d57;
+		static constexpr std::uint32_t k_weyl0 = 0x9e3779b9;
+		static constexpr std::uint32_t k_weyl1 = 0xbb67ae85;
+
+		std::array<std::uint32_t, 2> key;
+		std::uint64_t next = 0;
+		Block buffer{};
+		int used = 4;
+	};
+
+	/*
+	* Uniform integer in [0, bound) with Lemire's multiply and shift: no
+	* modulo bias and, except for the rare rejected draws, no division.
+	* Engines with 64 bit outputs contribute their high bits; std::mt19937
+	* has a wider result_type on some platforms but 32 bit outputs.
+	*/
+	template <class Rng>
+	std::uint32_t uniformBelow(Rng& rng, std::uint32_t bound) {
+		static_assert(Rng::min() == 0 && (Rng::max() == UINT32_MAX || Rng::max() == UINT64_MAX), "needs full 32 or 64 bit outputs");
+		auto draw = [&] {
+			if constexpr (Rng::max() > UINT32_MAX)
+				return static_cast<std::uint32_t>(rng() >> 32);
+			else
+				return static_cast<std::uint32_t>(rng());
+		};
+		std::uint64_t product = static_cast<std::uint64_t>(draw()) * bound;
+		std::uint32_t low = static_cast<std::uint32_t>(product);
+		if (low < bound) {
+			std::uint32_t threshold = (0u - bound) % bound;
+			while (low < threshold) {
+				product = static_cast<std::uint64_t>(draw()) * bound;
+				low = static_cast<std::uint32_t>(product);
+			}
+		}
+		return static_cast<std::uint32_t>(product >> 32);
+	}
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <climits>
+#include <algorithm>
+
+#include "SearchWorkspace.hpp"
+
+namespace dijkstra {
+
+	/*
+	* Search routines shared by every graph representation.
+	*
+	* A Graph only needs to provide size() and forEachNeighbour(node, fn), which
+	* calls fn(next_node) for every node reachable from node in one step.
+	* Graphs with terrain also provide cost(node), the cost of moving into node.
+	*/
+
+	using NodeDistancePair = std::tuple<int, int>;
+
+	/*
+	* Cost of the step into next_node, 1 for graphs without costs.
+	*/
+	template <class Graph>
+	int stepCost(const Graph& graph, int next_node) {
+		if constexpr (requires { graph.cost(next_node); })
+			return graph.cost(next_node);
+		else
+			return 1;
+	}
+
+	struct CompareDistance {
+		bool operator()(const NodeDistancePair& a, const NodeDistancePair& b) {
+			return std::get<1>(a) > std::get<1>(b);
+		}
+	};
+
+	/*
+	* Single source Dijkstra, returns the parent of every node in the shortest
+	* path tree rooted at start (-1 for the root and for unreachable nodes).
+	*
+	* The whole tree is returned, so the search is O(V) no matter what; a
+	* workspace only lends its heap, which keeps its capacity between calls.
+	*/
+	template <class Graph, class Queue = BinaryHeap>
+	std::vector<int> dijkstraParents(const Graph& graph, int start, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+		BasicSearchWorkspace<Queue> local_workspace{};
+		BasicSearchWorkspace<Queue>& search = workspace != nullptr ? *workspace : local_workspace;
+		search.reset(graph.size());
+
+		std::vector<int> distances(graph.size(), INT_MAX);
+		std::vector<int> parents(graph.size(), -1);
+
+		search.push(search.key(0, 0), start);
+		distances[start] = 0;
+
+		while (!search.heapEmpty()) {
+			auto [key, node] = search.pop();
+
+			// stale entry, node was already expanded with a better distance
+			if (keyPrimary(key) > distances[node])
+				continue;
+
+			graph.forEachNeighbour(node, [&](int next_node) {
+				int weight = stepCost(graph, next_node);
+
+				if (distances[next_node] > (distances[node] + weight)) {
+					distances[next_node] = (distances[node] + weight);
+					parents[next_node] = node;
+					search.push(search.key(distances[next_node], 0), next_node);
+				}
+			});
+		}
+		return parents;
+	}
+
+	/**
+	 * Shortest path tree grown by singleSourceTree(). Nodes the search did
+	 * not reach keep distance INT_MAX and parent -1, as does the source.
+	 * Reusing one across searches keeps the capacity of its arrays.
+	 */
+	struct SingleSourceTree {
+		std::vector<int> distances;
+		std::vector<int> parents;
+		// reached nodes as they were settled, source first, parents before children
+		std::vector<int> order;
+		BinaryHeap heap;
+	};
+
+	/*
+	* The default reach of singleSourceTree(), for callers that only need the tree.
+	*/
+	struct IgnoreReach {
+		void operator()(int, int, bool) const {
+		}
+	};
+
+	/*
+	* Every reachable node's distance, parent and settle order from source,
+	* breadth first on uniform costs and Dijkstra otherwise. Precomputed
+	* tables walk the order to pass per node values down the tree.
+	*
+	* reach(node, next_node, improved) sees every edge from a settled node
+	* that is on a shortest path to next_node so far: improved when it made
+	* node the new parent, false when it ties with the current distance.
+	* A node is settled only after every edge that reaches it this way.
+	*/
+	template <class Graph, class Reach = IgnoreReach>
+	void singleSourceTree(const Graph& graph, int source, SingleSourceTree& tree, Reach&& reach = {}) {
+		tree.distances.assign(graph.size(), INT_MAX);
+		tree.parents.assign(graph.size(), -1);
+		tree.order.assign(1, source);
+		tree.distances[source] = 0;
+
+		if (graph.uniformCost()) {
+			// order doubles as the breadth first queue
+			for (size_t i = 0; i < tree.order.size(); i++) {
+				int node = tree.order[i];
+				graph.forEachNeighbour(node, [&](int next_node) {
+					if (tree.distances[next_node] == INT_MAX) {
+						tree.distances[next_node] = tree.distances[node] + 1;
+						tree.parents[next_node] = node;
+						tree.order.push_back(next_node);
+						reach(node, next_node, true);
+					}
+					else if (tree.distances[next_node] == tree.distances[node] + 1) {
+						reach(node, next_node, false);
+					}
+				});
+			}
+			return;
+		}
+
+		tree.order.clear();
+		tree.heap.clear();
+		tree.heap.push(BinaryHeap::key(0, 0), source);
+		while (!tree.heap.empty()) {
+			auto [key, node] = tree.heap.pop();
+			int distance = tree.distances[node];
+			if (keyPrimary(key) > distance)
+				continue;
+			tree.order.push_back(node);
+			graph.forEachNeighbour(node, [&](int next_node) {
+				int next_distance = distance + stepCost(graph, next_node);
+				if (next_distance < tree.distances[next_node]) {
+					tree.distances[next_node] = next_distance;
+					tree.parents[next_node] = node;
+					tree.heap.push(BinaryHeap::key(next_distance, 0), next_node);
+					reach(node, next_node, true);
+				}
+				else if (next_distance == tree.distances[next_node]) {
+					reach(node, next_node, false);
+				}
+			});
+		}
+	}
+
+	/*
+	* Walks the parents array back from end.
+	*/
+	inline std::vector<int> pathFromParents(const std::vector<int>& parents, int end) {
+		std::vector<int> path{};
+		for (int i = end; i != -1; i = parents[i]) {
+			path.push_back(i);
+		}
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+
+#include "PriorityQueue.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * FIFO queue of nodes stored in a power of two ring buffer.
+	 * Grows when full, never shrinks, so it can be reused between searches.
+	 */
+	class RingQueue {
+	public:
+		RingQueue(int capacity = 64) {
+			int c = 1;
+			while (c < capacity)
+				c <<= 1;
+			buffer.resize(c);
+		}
+
+	public:
+		bool empty() const {
+			return head == tail;
+		}
+
+		int size() const {
+			return static_cast<int>(tail - head);
+		}
+
+		void clear() {
+			head = tail = 0;
+		}
+
+		void push(int node) {
+			if (tail - head == buffer.size())
+				grow();
+			buffer[tail++ & (buffer.size() - 1)] = node;
+		}
+
+		int pop() {
+			return buffer[head++ & (buffer.size() - 1)];
+		}
+
+	private:
+		void grow() {
+			std::vector<int> bigger(buffer.size() * 2);
+			size_t n = tail - head;
+			for (size_t i = 0; i < n; i++)
+				bigger[i] = buffer[(head + i) & (buffer.size() - 1)];
+			buffer.swap(bigger);
+			head = 0;
+			tail = n;
+		}
+
+	private:
+		std::vector<int> buffer;
+		size_t head = 0;
+		size_t tail = 0;
+	};
+
+	/**
+	 * Per node search state that survives between queries.
+	 *
+	 * Every node carries the generation it was last written in. Starting a new
+	 * search only bumps the generation, so nodes from older searches read as
+	 * untouched (infinite distance, no parent) without clearing anything:
+	 * reset is O(1) instead of O(V). The priority queue (any policy from
+	 * PriorityQueue.hpp) and the FIFO queues keep their capacity too, so short
+	 * queries on a warm workspace do not allocate.
+	 *
+	 * Stamps, distances and parents are separate arrays: "was this node seen"
+	 * is the hottest check of every search and only reads the dense stamps.
+	 * The two low bits of a stamp say which directions reached the node, so a
+	 * search growing from both ends checks the other side in the same word.
+	 * Distances and parents of the backward direction are allocated the
+	 * first time it is written.
+	 */
+	template <class Queue = BinaryHeap>
+	class BasicSearchWorkspace {
+	public:
+		enum { k_forward = 0, k_backward = 1 };
+
+		BasicSearchWorkspace(int size = 0) {
+			reset(size);
+		}
+
+	public:
+		/*
+		* Starts a new search over a graph with size nodes.
+		*/
+		void reset(int size) {
+			if (size != graph_size) {
+				graph_size = size;
+				stamps.clear();
+				for (NodeArrays& side : sides)
+					side = NodeArrays{};
+				generation = 0;
+				queued_nodes.resize(size);
+			}
+
+			// on wrap around old stamps could match again, clear them once
+			if (++generation == k_generations) {
+				std::fill(stamps.begin(), stamps.end(), 0);
+				generation = 1;
+			}
+
+			queued_nodes.clear();
+			for (RingQueue& queue : queues)
+				queue.clear();
+		}
+
+		int size() const {
+			return graph_size;
+		}
+
+		bool reached(int node, int side = k_forward) const {
+			if (stamps.empty())
+				return false;
+			std::uint32_t stamp = stamps[node];
+			return (stamp >> 2) == generation && (stamp >> side) & 1;
+		}
+
+		int distance(int node, int side = k_forward) const {
+			return reached(node, side) ? sides[side].distances[node] : INT_MAX;
+		}
+
+		int parent(int node, int side = k_forward) const {
+			return reached(node, side) ? sides[side].parents[node] : -1;
+		}
+
+		void update(int node, int distance, int parent, int side = k_forward) {
+			NodeArrays& arrays = touch(node, side);
+			arrays.distances[node] = distance;
+			arrays.parents[node] = parent;
+		}
+
+		/*
+		* Reaches node without recording a distance, for searches that track it
+		* per level instead; distance() of such a node is unspecified.
+		*/
+		void visit(int node, int parent, int side = k_forward) {
+			touch(node, side).parents[node] = parent;
+		}
+
+		/*
+		* Free byte per node for engine specific state. Only meaningful after
+		* setTag in the current search, the workspace does not clear it.
+		*/
+		int tag(int node, int side = k_forward) const {
+			return sides[side].tags[node];
+		}
+
+		void setTag(int node, int tag, int side = k_forward) {
+			touch(node, side).tags[node] = static_cast<std::int8_t>(tag);
+		}
+
+		/*
+		* Walks the parents back from end, end included, in reverse order.
+		*/
+		template <class Output>
+		void walkParents(int end, Output output, int side = k_forward) const {
+			for (int i = end; i != -1; i = parent(i, side))
+				output(i);
+		}
+
+		std::vector<int> pathTo(int end) const {
+			std::vector<int> path{};
+			walkParents(end, [&](int node) { path.push_back(node); });
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+	public:
+		/*
+		* Priority queue of the heap based engines, see PriorityQueue.hpp.
+		*/
+		static PriorityKey key(int primary, int tie_break) {
+			return Queue::key(primary, tie_break);
+		}
+
+		bool heapEmpty() const {
+			return queued_nodes.empty();
+		}
+
+		void push(PriorityKey key, int node) {
+			queued_nodes.push(key, node);
+		}
+
+		QueueEntry pop() {
+			return queued_nodes.pop();
+		}
+
+		RingQueue& queue(int side = k_forward) {
+			return queues[side];
+		}
+
+	private:
+		static constexpr std::uint32_t k_generations = 1u << 30;
+
+		struct NodeArrays {
+			std::vector<int> distances;
+			std::vector<int> parents;
+			std::vector<std::int8_t> tags;
+		};
+
+		/*
+		* Marks node as reached by side in this generation, dropping the bits
+		* an older search left behind.
+		*/
+		NodeArrays& touch(int node, int side) {
+			if (stamps.empty())
+				stamps.assign(graph_size, 0);
+			NodeArrays& arrays = sides[side];
+			if (arrays.distances.empty()) {
+				arrays.distances.resize(graph_size);
+				arrays.parents.resize(graph_size);
+				arrays.tags.resize(graph_size);
+			}
+
+			if ((stamps[node] >> 2) != generation)
+				stamps[node] = generation << 2;
+			stamps[node] |= 1u << side;
+			return arrays;
+		}
+
+	private:
+		int graph_size = -1;
+		std::uint32_t generation = 0;
+
+		// generation << 2 | one bit per direction that reached the node
+		std::vector<std::uint32_t> stamps;
+		NodeArrays sides[2];
+
+		Queue queued_nodes;
+		RingQueue queues[2];
+	};
+
+	using SearchWorkspace = BasicSearchWorkspace<>;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <type_traits>
+
+#include "Search.hpp"
+#include "SearchWorkspace.hpp"
+#include "AStar.hpp"
+#include "BreadthFirstSearch.hpp"
+#include "JumpPointSearch.hpp"
+#include "BidirectionalSearch.hpp"
+#include "DStarLite.hpp"
+
+namespace dijkstra {
+
+	/*
+	* Search engines a point to point query can be answered with.
+	*/
+	enum class SearchEngine {
+		Automatic,
+		Dijkstra,
+		AStar,
+		BreadthFirst,
+		JumpPoint,
+		Bidirectional,
+		Dial,
+		Incremental,
+	};
+
+	inline const char* searchEngineName(SearchEngine engine) {
+		switch (engine) {
+		case SearchEngine::Automatic:
+			return "Automatic";
+		case SearchEngine::Dijkstra:
+			return "Dijkstra";
+		case SearchEngine::AStar:
+			return "A*";
+		case SearchEngine::BreadthFirst:
+			return "Breadth first";
+		case SearchEngine::JumpPoint:
+			return "Jump point";
+		case SearchEngine::Bidirectional:
+			return "Bidirectional";
+		case SearchEngine::Dial:
+			return "Dial";
+		case SearchEngine::Incremental:
+			return "Incremental";
+		}
+		return "";
+	}
+
+	/*
+	* Shortest path tree rooted at start, as a parents array. Uniform cost
+	* graphs are searched breadth first instead of with a heap.
+	*/
+	template <class Graph, class Queue = BinaryHeap>
+	std::vector<int> shortestPathTree(const Graph& graph, int start, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+		if (graph.uniformCost())
+			return breadthFirstParents(graph, start, -1, workspace);
+		return dijkstraParents(graph, start, workspace);
+	}
+
+	/*
+	* Answers a point to point query with the requested engine. Automatic uses
+	* A* when the graph has grid geometry for the heuristic, otherwise breadth
+	* first search for uniform costs and Dijkstra for anything else. Engines
+	* that assume every step costs 1 fall back when the graph has terrain costs.
+	*
+	* Every engine runs on workspace when one is given; reusing the same one
+	* across queries avoids allocating and clearing per node arrays each time.
+	* The workspace's Queue picks the priority queue of the heap based engines.
+	* Dial only runs on a BucketQueue workspace: given another one it, and the
+	* engines falling back to it on terrain, allocate a fresh workspace per
+	* query, so callers with terrain keep a BasicSearchWorkspace<BucketQueue>.
+	*/
+	template <class Graph, class Queue = BinaryHeap>
+	std::optional<std::vector<int>> findPath(const Graph& graph, int start, int end, SearchEngine engine = SearchEngine::Automatic, BasicSearchWorkspace<Queue>* workspace = nullptr) {
+		switch (engine) {
+		case SearchEngine::Automatic:
+			if (graph.width() > 0)
+				return aStar(graph, start, end, manhattanDistance(graph), workspace);
+			if (graph.uniformCost())
+				return breadthFirstSearch(graph, start, end, workspace);
+			return aStar(graph, start, end, ZeroHeuristic{}, workspace);
+		case SearchEngine::Dijkstra:
+			return aStar(graph, start, end, ZeroHeuristic{}, workspace);
+		case SearchEngine::AStar:
+			if (graph.width() > 0)
+				return aStar(graph, start, end, manhattanDistance(graph), workspace);
+			return aStar(graph, start, end, ZeroHeuristic{}, workspace);
+		case SearchEngine::BreadthFirst:
+			if (!graph.uniformCost())
+				return findPath(graph, start, end, SearchEngine::Dial, workspace);
+			return breadthFirstSearch(graph, start, end, workspace);
+		case SearchEngine::JumpPoint:
+			// needs the packed passability rows, other graphs fall back to A*
+			if constexpr (requires { graph.passability(); }) {
+				if (graph.uniformCost())
+					return JumpPointSearch(graph.passability()).findPath(start, end, workspace);
+			}
+			return findPath(graph, start, end, SearchEngine::AStar, workspace);
+		case SearchEngine::Bidirectional:
+			if (!graph.uniformCost())
+				return findPath(graph, start, end, SearchEngine::Dial, workspace);
+			return BidirectionalSearch().findPath(graph, start, end, workspace);
+		case SearchEngine::Dial:
+			// Dijkstra over bucket queue, a workspace with another queue cannot be reused, see above
+			if constexpr (std::is_same_v<Queue, BucketQueue>)
+				return aStar(graph, start, end, ZeroHeuristic{}, workspace);
+			else
+				return aStar(graph, start, end, ZeroHeuristic{}, static_cast<BasicSearchWorkspace<BucketQueue>*>(nullptr));
+		case SearchEngine::Incremental:
+			// a one-off plan, keep a DStarLite around to replan after changes
+			return DStarLite<Graph>(graph, start, end).findPath();
+		}
+		return std::nullopt;
+	}
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <algorithm>
+
+#include "Search.hpp"
+
+namespace dijkstra {
+
+	/**
+	 * Path queries on a graph without cycles, such as a perfect maze.
+	 *
+	 * In a forest there is exactly one path between two nodes, through their
+	 * lowest common ancestor, so no search is needed: the index roots every
+	 * tree, records parents, depths and the cost from the root, and splits
+	 * the trees into heavy paths. The lowest common ancestor is then found by
+	 * jumping at most O(log n) heavy paths, a distance costs one such lookup
+	 * and a path is walked from both ends in O(path length).
+	 *
+	 * The index is a snapshot of the graph and its costs, rebuild it after
+	 * editing. Building stops at the first cycle and isTree() turns false;
+	 * queries must then go to a search engine.
+	 */
+	class TreeIndex {
+	public:
+		TreeIndex() = default;
+
+		template <class Graph>
+		TreeIndex(const Graph& graph) {
+			build(graph);
+		}
+
+	public:
+		template <class Graph>
+		void build(const Graph& graph) {
+			int size = graph.size();
+			parents.assign(size, -1);
+			depths.assign(size, -1);
+			root_costs.assign(size, 0);
+			roots.assign(size, -1);
+			tree = true;
+
+			std::vector<int> order;
+			order.reserve(size);
+			for (int root = 0; root < size && tree; root++) {
+				if (depths[root] != -1)
+					continue;
+
+				depths[root] = 0;
+				root_costs[root] = stepCost(graph, root);
+				roots[root] = root;
+				size_t begin = order.size();
+				order.push_back(root);
+				for (size_t i = begin; i < order.size() && tree; i++) {
+					int node = order[i];
+					graph.forEachNeighbour(node, [&](int next_node) {
+						if (next_node == parents[node])
+							return;
+						if (depths[next_node] != -1) {
+							// reached twice: a cycle
+							tree = false;
+							return;
+						}
+						parents[next_node] = node;
+						depths[next_node] = depths[node] + 1;
+						root_costs[next_node] = root_costs[node] + stepCost(graph, next_node);
+						roots[next_node] = root;
+						order.push_back(next_node);
+					});
+				}
+			}
+
+			if (!tree) {
+				clear();
+				return;
+			}
+			decompose(order);
+		}
+
+		bool isTree() const {
+			return tree;
+		}
+
+		/*
+		* -1 when a and b are in different trees.
+		*/
+		int lowestCommonAncestor(int a, int b) const {
+			if (roots[a] != roots[b])
+				return -1;
+			while (heads[a] != heads[b]) {
+				if (depths[heads[a]] > depths[heads[b]])
+					a = parents[heads[a]];
+				else
+					b = parents[heads[b]];
+			}
+			return depths[a] < depths[b] ? a : b;
+		}
+
+		/*
+		* Cost of the path from a to b, the sum of stepCost over every node
+		* entered after a.
+		*/
+		std::optional<int> distance(int a, int b) const {
+			int ancestor = lowestCommonAncestor(a, b);
+			if (ancestor == -1)
+				return std::nullopt;
+			// the path climbs to ancestor, entering it only when coming from b's side
+			return root_costs[a] + root_costs[b] - 2 * root_costs[ancestor] + nodeCost(ancestor) - nodeCost(a);
+		}
+
+		std::optional<std::vector<int>> path(int a, int b) const {
+			int ancestor = lowestCommonAncestor(a, b);
+			if (ancestor == -1)
+				return std::nullopt;
+
+			std::vector<int> path{};
+			path.reserve(depths[a] + depths[b] - 2 * depths[ancestor] + 1);
+			for (int node = a; node != ancestor; node = parents[node])
+				path.push_back(node);
+			size_t climbed = path.size();
+			for (int node = b; node != ancestor; node = parents[node])
+				path.push_back(node);
+			path.push_back(ancestor);
+			std::reverse(path.begin() + climbed, path.end());
+			return path;
+		}
+
+	private:
+		/*
+		* Heavy path heads from the breadth first order: children follow
+		* their parent, so subtree sizes add up in reverse and heads pass
+		* down in order.
+		*/
+		void decompose(const std::vector<int>& order) {
+			int size = static_cast<int>(parents.size());
+			std::vector<int> subtree_sizes(size, 1);
+			std::vector<int> heavy_children(size, -1);
+			for (auto it = order.rbegin(); it != order.rend(); ++it) {
+				int node = *it;
+				int parent = parents[node];
+				if (parent == -1)
+					continue;
+				subtree_sizes[parent] += subtree_sizes[node];
+				if (heavy_children[parent] == -1 || subtree_sizes[node] > subtree_sizes[heavy_children[parent]])
+					heavy_children[parent] = node;
+			}
+
+			heads.resize(size);
+			for (int node : order) {
+				int parent = parents[node];
+				heads[node] = parent != -1 && heavy_children[parent] == node ? heads[parent] : node;
+			}
+		}
+
+		int nodeCost(int node) const {
+			int parent = parents[node];
+			return parent == -1 ? root_costs[node] : root_costs[node] - root_costs[parent];
+		}
+
+		void clear() {
+			parents.clear();
+			depths.clear();
+			root_costs.clear();
+			roots.clear();
+			heads.clear();
+		}
+
+	private:
+		bool tree = false;
+
+		std::vector<int> parents;
+		std::vector<int> depths;
+		std::vector<int> root_costs;
+		std::vector<int> roots;
+		std::vector<int> heads;
+	};
+};